@@ -8,8 +8,18 @@
 #define ADAPTIVERANDOMSEARCH_H_0A627B1E_280C_11E5_85AF_C038963D1C06
 
 
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <utility>
 #include <vector>
 
+#include "../Common/Objectives.h"
+#include "../Common/Random.h"
+
 
 namespace CleverAlgorithms
 {
@@ -18,22 +28,289 @@ class AdaptiveRandomSearch
 {
 public:
 
-    struct Candidate
+    template <typename Values>
+    struct BasicCandidate
     {
-        std::vector<float> values;
+        Values values;
         float cost;
     };
 
+    typedef BasicCandidate<std::vector<float>> Candidate;
+
+    /* Candidate of a dimension known at compile time: the search allocates nothing. */
+    template <size_t N>
+    using FixedCandidate = BasicCandidate<std::array<float, N>>;
+
+    typedef std::function<float(const std::vector<float>&)> Objective;
+
+
+    /* Minimizes the sphere function. */
+    static Candidate search(const std::vector<std::pair<float, float>>& bounds,
+                            const int kIterLimit,
+                            const float kInitFactor,
+                            const float kSmallFactor,
+                            const float kLargeFactor,
+                            const int kIterMult,
+                            const int kNoImproveLimit,
+                            const uint64_t kSeed);
+
+    /* Type-erased objective: for expensive objectives or ones chosen at run time. */
+    static Candidate search(const std::vector<std::pair<float, float>>& bounds,
+                            const int kIterLimit,
+                            const float kInitFactor,
+                            const float kSmallFactor,
+                            const float kLargeFactor,
+                            const int kIterMult,
+                            const int kNoImproveLimit,
+                            const Objective& objective,
+                            const uint64_t kSeed);
 
+    /* Any callable taking const std::vector<float>& and returning float; it is inlined into the search loop. */
+    template <typename Function>
     static Candidate search(const std::vector<std::pair<float, float>>& bounds,
                             const int kIterLimit,
                             const float kInitFactor,
                             const float kSmallFactor,
                             const float kLargeFactor,
                             const int kIterMult,
-                            const int kNoImproveLimit);
+                            const int kNoImproveLimit,
+                            Function objective,
+                            const uint64_t kSeed);
+
+    /* Fixed dimension N: objective takes const std::array<float, N>&. */
+    template <size_t N, typename Function>
+    static FixedCandidate<N> search(const std::array<std::pair<float, float>, N>& bounds,
+                                    const int kIterLimit,
+                                    const float kInitFactor,
+                                    const float kSmallFactor,
+                                    const float kLargeFactor,
+                                    const int kIterMult,
+                                    const int kNoImproveLimit,
+                                    Function objective,
+                                    const uint64_t kSeed);
+
+private:
+
+    static void resize(std::vector<float>& values, const size_t size)
+    {
+        values.resize(size);
+    }
+
+    template <size_t N>
+    static void resize(std::array<float, N>&, const size_t)
+    {
+    }
+
+    static float largeStepSize(const int kIter, const float kStepSize, const float kSmallFactor, const float kLargeFactor, const int kIterMult)
+    {
+        assert(kIterMult != 0);
+
+        if (kIter > 0 && kIter % kIterMult == 0)
+        {
+            return kStepSize * kLargeFactor;
+        }
+        return kStepSize * kSmallFactor;
+    }
+
+    template <typename Values>
+    static void takeStep(const Values& lower,
+                         const Values& upper,
+                         const Values& current,
+                         const float kStepSize,
+                         const Values& units,
+                         Values& position);
+
+    template <typename Values, typename Function>
+    static void takeSteps(const Values& lower,
+                          const Values& upper,
+                          const BasicCandidate<Values>& current,
+                          const float kStepSize,
+                          const float kBigStepSize,
+                          const Values& units,
+                          const Values& bigUnits,
+                          Function& objective,
+                          BasicCandidate<Values>& ordinaryStep,
+                          BasicCandidate<Values>& bigStep);
+
+    template <typename Values>
+    static void takeSteps(const Values& lower,
+                          const Values& upper,
+                          const BasicCandidate<Values>& current,
+                          const float kStepSize,
+                          const float kBigStepSize,
+                          const Values& units,
+                          const Values& bigUnits,
+                          SphereFunction& objective,
+                          BasicCandidate<Values>& ordinaryStep,
+                          BasicCandidate<Values>& bigStep);
+
+    template <typename Values, typename Bounds, typename Function>
+    static BasicCandidate<Values> adapt(const Bounds& bounds,
+                                        const int kIterLimit,
+                                        const float kInitFactor,
+                                        const float kSmallFactor,
+                                        const float kLargeFactor,
+                                        const int kIterMult,
+                                        const int kNoImproveLimit,
+                                        Function& objective,
+                                        const uint64_t kSeed);
 };
 
+
+template <typename Function>
+AdaptiveRandomSearch::Candidate AdaptiveRandomSearch::search(const std::vector<std::pair<float, float>>& bounds,
+                                                             const int kIterLimit, const float kInitFactor,
+                                                             const float kSmallFactor, const float kLargeFactor,
+                                                             const int kIterMult, const int kNoImproveLimit,
+                                                             Function objective,
+                                                             const uint64_t kSeed)
+{
+    return adapt<std::vector<float>>(bounds, kIterLimit, kInitFactor, kSmallFactor, kLargeFactor, kIterMult, kNoImproveLimit, objective, kSeed);
+}
+
+
+template <size_t N, typename Function>
+AdaptiveRandomSearch::FixedCandidate<N> AdaptiveRandomSearch::search(const std::array<std::pair<float, float>, N>& bounds,
+                                                                     const int kIterLimit, const float kInitFactor,
+                                                                     const float kSmallFactor, const float kLargeFactor,
+                                                                     const int kIterMult, const int kNoImproveLimit,
+                                                                     Function objective,
+                                                                     const uint64_t kSeed)
+{
+    return adapt<std::array<float, N>>(bounds, kIterLimit, kInitFactor, kSmallFactor, kLargeFactor, kIterMult, kNoImproveLimit, objective, kSeed);
+}
+
+
+/* Uniform position within kStepSize of current, clamped to the bounds; units holds the uniform [0, 1) draws. */
+template <typename Values>
+void AdaptiveRandomSearch::takeStep(const Values& lower,
+                                    const Values& upper,
+                                    const Values& current,
+                                    const float kStepSize,
+                                    const Values& units,
+                                    Values& position)
+{
+    for (size_t i = 0; i < current.size(); ++i)
+    {
+        float left = std::max(lower[i], current[i] - kStepSize);
+        float right = std::min(upper[i], current[i] + kStepSize);
+        position[i] = left + (right - left) * units[i];
+    }
+}
+
+
+template <typename Values, typename Function>
+void AdaptiveRandomSearch::takeSteps(const Values& lower,
+                                     const Values& upper,
+                                     const BasicCandidate<Values>& current,
+                                     const float kStepSize,
+                                     const float kBigStepSize,
+                                     const Values& units,
+                                     const Values& bigUnits,
+                                     Function& objective,
+                                     BasicCandidate<Values>& ordinaryStep,
+                                     BasicCandidate<Values>& bigStep)
+{
+    takeStep(lower, upper, current.values, kStepSize, units, ordinaryStep.values);
+    takeStep(lower, upper, current.values, kBigStepSize, bigUnits, bigStep.values);
+    ordinaryStep.cost = objective(static_cast<const Values&>(ordinaryStep.values));
+    bigStep.cost = objective(static_cast<const Values&>(bigStep.values));
+}
+
+
+/* The sphere function is separable: both steps are generated and evaluated in a single pass. */
+template <typename Values>
+void AdaptiveRandomSearch::takeSteps(const Values& lower,
+                                     const Values& upper,
+                                     const BasicCandidate<Values>& current,
+                                     const float kStepSize,
+                                     const float kBigStepSize,
+                                     const Values& units,
+                                     const Values& bigUnits,
+                                     SphereFunction&,
+                                     BasicCandidate<Values>& ordinaryStep,
+                                     BasicCandidate<Values>& bigStep)
+{
+    float cost = 0.0f, bigCost = 0.0f;
+    for (size_t i = 0; i < current.values.size(); ++i)
+    {
+        float left = std::max(lower[i], current.values[i] - kStepSize);
+        float right = std::min(upper[i], current.values[i] + kStepSize);
+        float bigLeft = std::max(lower[i], current.values[i] - kBigStepSize);
+        float bigRight = std::min(upper[i], current.values[i] + kBigStepSize);
+        ordinaryStep.values[i] = left + (right - left) * units[i];
+        bigStep.values[i] = bigLeft + (bigRight - bigLeft) * bigUnits[i];
+        cost += ordinaryStep.values[i] * ordinaryStep.values[i];
+        bigCost += bigStep.values[i] * bigStep.values[i];
+    }
+    ordinaryStep.cost = cost;
+    bigStep.cost = bigCost;
+}
+
+
+template <typename Values, typename Bounds, typename Function>
+AdaptiveRandomSearch::BasicCandidate<Values> AdaptiveRandomSearch::adapt(const Bounds& bounds,
+                                                                         const int kIterLimit, const float kInitFactor,
+                                                                         const float kSmallFactor, const float kLargeFactor,
+                                                                         const int kIterMult, const int kNoImproveLimit,
+                                                                         Function& objective,
+                                                                         const uint64_t kSeed)
+{
+    assert(bounds.size());
+
+    Random random(kSeed);
+
+    /* All buffers are allocated once; accepting a step swaps it with best. */
+    BasicCandidate<Values> best, ordinaryStep, bigStep;
+    Values lower, upper, units, bigUnits;
+    resize(best.values, bounds.size());
+    resize(ordinaryStep.values, bounds.size());
+    resize(bigStep.values, bounds.size());
+    resize(lower, bounds.size());
+    resize(upper, bounds.size());
+    resize(units, bounds.size());
+    resize(bigUnits, bounds.size());
+    for (size_t i = 0; i < bounds.size(); ++i)
+    {
+        lower[i] = bounds[i].first;
+        upper[i] = bounds[i].second;
+        best.values[i] = random.uniformFloat(lower[i], upper[i]);
+    }
+    best.cost = objective(static_cast<const Values&>(best.values));
+    int count = 0;
+    float stepSize = (bounds[0].second - bounds[0].first) * kInitFactor;
+    for (int iter = 0; iter < kIterLimit; ++iter)
+    {
+        float bigStepSize = largeStepSize(iter, stepSize, kSmallFactor, kLargeFactor, kIterMult);
+        random.fill(units.data(), units.data() + units.size(), 0.0f, 1.0f);
+        random.fill(bigUnits.data(), bigUnits.data() + bigUnits.size(), 0.0f, 1.0f);
+        takeSteps(lower, upper, best, stepSize, bigStepSize, units, bigUnits, objective, ordinaryStep, bigStep);
+        if (ordinaryStep.cost <= best.cost || bigStep.cost <= best.cost)
+        {
+            if (bigStep.cost <= ordinaryStep.cost)
+            {
+                stepSize = bigStepSize;
+                std::swap(best, bigStep);
+            }
+            else
+            {
+                std::swap(best, ordinaryStep);
+            }
+            count = 0;
+        }
+        else
+        {
+            ++count;
+            if (count >= kNoImproveLimit)
+            {
+                count = 0;
+                stepSize /= kSmallFactor;
+            }
+        }
+    }
+    return best;
+}
+
 } /* namespace CleverAlgorithms */
 
 #endif /* ADAPTIVERANDOMSEARCH_H_0A627B1E_280C_11E5_85AF_C038963D1C06 */
@@ -4,6 +4,7 @@
  */
 
 
+#include <ctime>
 #include <iomanip>
 #include <iostream>
 #include <vector>
@@ -39,6 +40,7 @@ int main()
     const float kLargeFactor = 3.0f;
     const int kIterMult = 10;
     const int kNoImproveLimit = 30;
+    const uint64_t kSeed = static_cast<uint64_t>(time(nullptr));
 
     CleverAlgorithms::AdaptiveRandomSearch::Candidate result = CleverAlgorithms::AdaptiveRandomSearch::search(bounds,
                                                                                                               kIterLimit,
@@ -46,7 +48,8 @@ int main()
                                                                                                               kSmallFactor,
                                                                                                               kLargeFactor,
                                                                                                               kIterMult,
-                                                                                                              kNoImproveLimit);
+                                                                                                              kNoImproveLimit,
+                                                                                                              kSeed);
     printResult(result);
     return 0;
 }
@@ -0,0 +1,115 @@
+/*
+ * Filename: Main.cpp
+ * Author:   Michael Tkach (x1mike7x@gmail.com)
+ */
+
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <iostream>
+#include <thread>
+#include <vector>
+
+#include "../../Common/Random.h"
+#include "../../Perceptron/Perceptron.h"
+
+
+namespace
+{
+
+const size_t kSparseRows = 200000;
+const size_t kSparseInputs = 1000000;
+const size_t kSparseNonZeros = 32;
+const size_t kDenseRows = 50000;
+const size_t kDenseInputs = 256;
+const size_t kIterations = 3;
+const size_t kBatchSize = 256;
+const float kLearningRate = 0.01f;
+const uint64_t kSeed = 1;
+
+
+/* The label is set when the pattern weighs more on the first half of the inputs than on the second. */
+inline CleverAlgorithms::SparseDataset sparseDataset(CleverAlgorithms::Random& random)
+{
+    CleverAlgorithms::SparseDataset res(kSparseInputs);
+    std::vector<uint32_t> indices(kSparseNonZeros);
+    std::vector<float> values(kSparseNonZeros);
+    for (size_t row = 0; row < kSparseRows; ++row)
+    {
+        float balance = 0.0f;
+        for (size_t i = 0; i < kSparseNonZeros; ++i)
+        {
+            indices[i] = random.uniformInt(kSparseInputs);
+            values[i] = random.uniformFloat();
+            balance += indices[i] < kSparseInputs / 2 ? values[i] : -values[i];
+        }
+        res.push(indices.begin(), indices.end(), values.begin(), balance > 0.0f ? 1.0f : 0.0f);
+    }
+    return res;
+}
+
+
+inline CleverAlgorithms::DenseDataset denseDataset(CleverAlgorithms::Random& random)
+{
+    CleverAlgorithms::DenseDataset res(kDenseInputs);
+    res.reserve(kDenseRows);
+    std::vector<float> values(kDenseInputs);
+    for (size_t row = 0; row < kDenseRows; ++row)
+    {
+        random.fill(values, -1.0f, 1.0f);
+        float balance = 0.0f;
+        for (size_t i = 0; i < kDenseInputs; ++i)
+        {
+            balance += i < kDenseInputs / 2 ? values[i] : -values[i];
+        }
+        res.push(values.begin(), balance > 0.0f ? 1.0f : 0.0f);
+    }
+    return res;
+}
+
+
+template <typename Train>
+inline double samplesPerSecond(const size_t rows, Train train)
+{
+    const auto start = std::chrono::steady_clock::now();
+    train();
+    const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    return rows * kIterations / seconds;
+}
+
+} /* anonymous namespace */
+
+
+int main()
+{
+    CleverAlgorithms::Random random(kSeed);
+    const CleverAlgorithms::SparseDataset sparse = sparseDataset(random);
+    const CleverAlgorithms::DenseDataset dense = denseDataset(random);
+
+    /* Training logs every epoch; only the throughput is of interest here. */
+    std::clog.rdbuf(nullptr);
+
+    const unsigned maxThreads = std::max(1u, std::thread::hardware_concurrency());
+    std::vector<unsigned> threads;
+    for (unsigned count = 1; count < maxThreads; count *= 2)
+    {
+        threads.push_back(count);
+    }
+    threads.push_back(maxThreads);
+
+    std::cout << "threads\thogwild sparse, samples/s\tmini-batch dense, samples/s\n";
+    for (size_t i = 0; i < threads.size(); ++i)
+    {
+        const double hogwild = samplesPerSecond(sparse.size(), [&]
+        {
+            (void)CleverAlgorithms::Perceptron::executeHogwild(sparse, kIterations, kLearningRate, threads[i], kSeed);
+        });
+        const double miniBatch = samplesPerSecond(dense.size(), [&]
+        {
+            (void)CleverAlgorithms::Perceptron::executeMiniBatch(dense, kIterations, kLearningRate, kBatchSize, threads[i], kSeed);
+        });
+        std::cout << threads[i] << "\t" << hogwild << "\t" << miniBatch << "\n";
+    }
+    return 0;
+}
@@ -0,0 +1,151 @@
+/*
+ * Filename: Main.cpp
+ * Author:   Michael Tkach (x1mike7x@gmail.com)
+ */
+
+
+#include <chrono>
+#include <cstdint>
+#include <iostream>
+#include <numeric>
+#include <vector>
+
+#include "../../Common/ArrayTour.h"
+#include "../../Common/Random.h"
+#include "../../Common/TwoLevelListTour.h"
+
+
+namespace
+{
+
+const uint32_t kCheckSize = 1000;
+const int kCheckReversals = 20000;
+const int kReversals = 5000;
+const uint64_t kSeed = 1;
+const size_t kMaxCities = 1024000;
+
+
+inline std::vector<int> randomPermutation(const size_t size, CleverAlgorithms::Random& random)
+{
+    std::vector<int> res(size);
+    std::iota(res.begin(), res.end(), 0);
+    for (size_t i = 0; i < res.size(); ++i)
+    {
+        int r = random.uniformInt(static_cast<uint32_t>(res.size() - i)) + i;
+        std::swap(res[i], res[r]);
+    }
+    return res;
+}
+
+
+/* Both tours must describe the same cycle, in the same or in the opposite direction. */
+inline bool sameCycle(const CleverAlgorithms::ArrayTour& expected, const CleverAlgorithms::TwoLevelListTour& tour)
+{
+    const int start = 0;
+    const bool forward = expected.next(start) == tour.next(start);
+    int a = start, b = start;
+    for (size_t i = 0; i < expected.size(); ++i)
+    {
+        a = expected.next(a);
+        b = forward ? tour.next(b) : tour.prev(b);
+        if (a != b)
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+
+inline bool check(CleverAlgorithms::Random& random)
+{
+    CleverAlgorithms::ArrayTour expected;
+    CleverAlgorithms::TwoLevelListTour tour;
+    const std::vector<int> permutation = randomPermutation(kCheckSize, random);
+    expected.assign(permutation);
+    tour.assign(permutation);
+    for (int i = 0; i < kCheckReversals; ++i)
+    {
+        const int a = random.uniformInt(kCheckSize),
+                  b = random.uniformInt(kCheckSize);
+        /* Either tour may reverse the complementary path, so their directions can disagree. */
+        if (expected.next(0) == tour.next(0))
+        {
+            expected.reverse(a, b);
+        }
+        else
+        {
+            expected.reverse(b, a);
+        }
+        tour.reverse(a, b);
+        if (!sameCycle(expected, tour))
+        {
+            return false;
+        }
+        const int c = random.uniformInt(kCheckSize);
+        const bool forward = expected.next(0) == tour.next(0);
+        if (expected.between(a, b, c) != (forward ? tour.between(a, b, c) : tour.between(c, b, a)))
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+
+/* Average time of one reverse(a, b) with uniformly random endpoints, in microseconds. */
+template <typename Tour>
+inline double measure(const std::vector<int>& permutation, const std::vector<std::pair<int, int>>& reversals)
+{
+    Tour tour;
+    tour.assign(permutation);
+    const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < reversals.size(); ++i)
+    {
+        tour.reverse(reversals[i].first, reversals[i].second);
+    }
+    const std::chrono::steady_clock::time_point finish = std::chrono::steady_clock::now();
+    return std::chrono::duration<double, std::micro>(finish - start).count() / reversals.size();
+}
+
+} /* anonymous namespace */
+
+
+int main()
+{
+    CleverAlgorithms::Random random(kSeed);
+    if (!check(random))
+    {
+        std::cerr << "TwoLevelListTour disagrees with ArrayTour\n";
+        return 1;
+    }
+
+    size_t crossover = 0;
+    std::cout << "Cities\tArrayTour, us\tTwoLevelListTour, us\n";
+    for (size_t n = 1000; n <= kMaxCities; n *= 2)
+    {
+        const std::vector<int> permutation = randomPermutation(n, random);
+        std::vector<std::pair<int, int>> reversals(kReversals);
+        for (size_t i = 0; i < reversals.size(); ++i)
+        {
+            reversals[i] = std::make_pair(random.uniformInt(static_cast<uint32_t>(n)), random.uniformInt(static_cast<uint32_t>(n)));
+        }
+        const double array = measure<CleverAlgorithms::ArrayTour>(permutation, reversals);
+        const double list = measure<CleverAlgorithms::TwoLevelListTour>(permutation, reversals);
+        std::cout << n << "\t" << array << "\t" << list << "\n";
+        if (!crossover && list < array)
+        {
+            crossover = n;
+        }
+    }
+
+    if (crossover)
+    {
+        std::cout << "\nTwoLevelListTour is faster from " << crossover << " cities\n";
+    }
+    else
+    {
+        std::cout << "\nArrayTour is faster at every measured size\n";
+    }
+    return 0;
+}
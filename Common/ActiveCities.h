@@ -0,0 +1,68 @@
+/*
+ * Filename: ActiveCities.h
+ * Author:   Michael Tkach (x1mike7x@gmail.com)
+ */
+
+
+#ifndef ACTIVECITIES_H_C4C657DB_C9F3_11F1_85BB_C038963D1C06
+#define ACTIVECITIES_H_C4C657DB_C9F3_11F1_85BB_C038963D1C06
+
+
+#include <cassert>
+#include <cstddef>
+#include <vector>
+
+
+namespace CleverAlgorithms
+{
+
+/* Queue of cities whose don't-look bit is off; each city is queued at most once. */
+class ActiveCities
+{
+public:
+
+    explicit ActiveCities(const size_t size)
+        : queue_(size)
+        , queued_(size, 0)
+        , head_(0)
+        , count_(0)
+    {
+    }
+
+    void push(const int city)
+    {
+        if (!queued_[city])
+        {
+            queued_[city] = 1;
+            queue_[(head_ + count_) % queue_.size()] = city;
+            ++count_;
+        }
+    }
+
+    int pop()
+    {
+        assert(count_);
+
+        int city = queue_[head_];
+        head_ = head_ + 1 == queue_.size() ? 0 : head_ + 1;
+        --count_;
+        queued_[city] = 0;
+        return city;
+    }
+
+    bool empty() const
+    {
+        return !count_;
+    }
+
+private:
+
+    std::vector<int> queue_;
+    std::vector<char> queued_;
+    size_t head_;
+    size_t count_;
+};
+
+} /* namespace CleverAlgorithms */
+
+#endif /* ACTIVECITIES_H_C4C657DB_C9F3_11F1_85BB_C038963D1C06 */
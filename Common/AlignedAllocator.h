@@ -0,0 +1,74 @@
+/*
+ * Filename: AlignedAllocator.h
+ * Author:   Michael Tkach (x1mike7x@gmail.com)
+ */
+
+
+#ifndef ALIGNEDALLOCATOR_H_C4C65A3B_C9F3_11F1_8E61_C038963D1C06
+#define ALIGNEDALLOCATOR_H_C4C65A3B_C9F3_11F1_8E61_C038963D1C06
+
+
+#include <cstddef>
+#include <cstdint>
+#include <new>
+
+
+namespace CleverAlgorithms
+{
+
+/* Allocator for std::vector whose storage starts on an Alignment-byte boundary, e.g. a cache line for SIMD loads. */
+template <typename T, size_t Alignment>
+class AlignedAllocator
+{
+public:
+
+    typedef T value_type;
+
+    template <typename U>
+    struct rebind
+    {
+        typedef AlignedAllocator<U, Alignment> other;
+    };
+
+
+    AlignedAllocator()
+    {
+    }
+
+    template <typename U>
+    AlignedAllocator(const AlignedAllocator<U, Alignment>&)
+    {
+    }
+
+    /* The pointer returned by operator new is kept just before the aligned block. */
+    T* allocate(const size_t n)
+    {
+        void* raw = ::operator new(n * sizeof(T) + sizeof(void*) + Alignment - 1);
+        const uintptr_t aligned = (reinterpret_cast<uintptr_t>(raw) + sizeof(void*) + Alignment - 1) & ~static_cast<uintptr_t>(Alignment - 1);
+        reinterpret_cast<void**>(aligned)[-1] = raw;
+        return reinterpret_cast<T*>(aligned);
+    }
+
+    void deallocate(T* p, const size_t)
+    {
+        ::operator delete(reinterpret_cast<void**>(p)[-1]);
+    }
+};
+
+
+template <typename T, typename U, size_t Alignment>
+bool operator==(const AlignedAllocator<T, Alignment>&, const AlignedAllocator<U, Alignment>&)
+{
+    return true;
+}
+
+
+template <typename T, typename U, size_t Alignment>
+bool operator!=(const AlignedAllocator<T, Alignment>&, const AlignedAllocator<U, Alignment>&)
+{
+    return false;
+}
+
+} /* namespace CleverAlgorithms */
+
+#endif /* ALIGNEDALLOCATOR_H_C4C65A3B_C9F3_11F1_8E61_C038963D1C06 */
@@ -0,0 +1,52 @@
+/*
+ * Filename: ArrayTour.cpp
+ * Author:   Michael Tkach (x1mike7x@gmail.com)
+ */
+
+
+#include <algorithm>
+
+#include "ArrayTour.h"
+
+
+namespace CleverAlgorithms
+{
+
+void ArrayTour::assign(const std::vector<int>& permutation)
+{
+    permutation_ = permutation;
+    position_.resize(permutation_.size());
+    for (size_t i = 0; i < permutation_.size(); ++i)
+    {
+        position_[permutation_[i]] = i;
+    }
+}
+
+
+void ArrayTour::reverse(const int a, const int b)
+{
+    const size_t n = permutation_.size();
+    size_t i = position_[a],
+           j = position_[b];
+    size_t length = (j + n - i) % n + 1;
+    if (2 * length > n)
+    {
+        std::swap(i, j);
+        i = i + 1 == n ? 0 : i + 1;
+        j = j ? j - 1 : n - 1;
+        length = n - length;
+    }
+    for (size_t k = 0; k < length / 2; ++k)
+    {
+        int ci = permutation_[i],
+            cj = permutation_[j];
+        permutation_[i] = cj;
+        position_[cj] = i;
+        permutation_[j] = ci;
+        position_[ci] = j;
+        i = i + 1 == n ? 0 : i + 1;
+        j = j ? j - 1 : n - 1;
+    }
+}
+
+} /* namespace CleverAlgorithms */
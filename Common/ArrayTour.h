@@ -0,0 +1,70 @@
+/*
+ * Filename: ArrayTour.h
+ * Author:   Michael Tkach (x1mike7x@gmail.com)
+ */
+
+
+#ifndef ARRAYTOUR_H_C4C65718_C9F3_11F1_8F68_C038963D1C06
+#define ARRAYTOUR_H_C4C65718_C9F3_11F1_8F68_C038963D1C06
+
+
+#include <cstddef>
+#include <vector>
+
+
+namespace CleverAlgorithms
+{
+
+/*
+ * Tour stored as a permutation with a position index: O(1) next/prev/between, O(n) reverse.
+ * ArrayTour and TwoLevelListTour share this interface and are interchangeable as template arguments.
+ */
+class ArrayTour
+{
+public:
+
+    void assign(const std::vector<int>& permutation);
+
+    void permutation(std::vector<int>& result) const
+    {
+        result = permutation_;
+    }
+
+    size_t size() const
+    {
+        return permutation_.size();
+    }
+
+    int next(const int city) const
+    {
+        size_t i = position_[city] + 1;
+        return permutation_[i == permutation_.size() ? 0 : i];
+    }
+
+    int prev(const int city) const
+    {
+        size_t i = position_[city];
+        return permutation_[i ? i - 1 : permutation_.size() - 1];
+    }
+
+    /* Whether b lies on the path from a to c following next(). */
+    bool between(const int a, const int b, const int c) const
+    {
+        const size_t i = position_[a],
+                     j = position_[b],
+                     k = position_[c];
+        return i <= k ? (i <= j && j <= k) : (i <= j || j <= k);
+    }
+
+    /* Reverses the path from a to b, or the complementary one if it is shorter: the cycle is the same either way. */
+    void reverse(const int a, const int b);
+
+private:
+
+    std::vector<int> permutation_;
+    std::vector<size_t> position_;
+};
+
+} /* namespace CleverAlgorithms */
+
+#endif /* ARRAYTOUR_H_C4C65718_C9F3_11F1_8F68_C038963D1C06 */
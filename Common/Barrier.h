@@ -0,0 +1,58 @@
+/*
+ * Filename: Barrier.h
+ * Author:   Michael Tkach (x1mike7x@gmail.com)
+ */
+
+
+#ifndef BARRIER_H_C4C65AD7_C9F3_11F1_9F0E_C038963D1C06
+#define BARRIER_H_C4C65AD7_C9F3_11F1_9F0E_C038963D1C06
+
+
+#include <condition_variable>
+#include <cstddef>
+#include <mutex>
+
+
+namespace CleverAlgorithms
+{
+
+/* Reusable barrier: the last thread to arrive runs the completion step before everyone is released. */
+class Barrier
+{
+public:
+
+    explicit Barrier(const size_t count)
+        : count_(count)
+        , waiting_(0)
+        , generation_(0)
+    {
+    }
+
+    template <typename Completion>
+    void wait(Completion completion)
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+        const size_t generation = generation_;
+        if (++waiting_ == count_)
+        {
+            completion();
+            waiting_ = 0;
+            ++generation_;
+            condition_.notify_all();
+            return;
+        }
+        condition_.wait(lock, [this, generation] { return generation != generation_; });
+    }
+
+private:
+
+    std::mutex mutex_;
+    std::condition_variable condition_;
+    const size_t count_;
+    size_t waiting_;
+    size_t generation_;
+};
+
+} /* namespace CleverAlgorithms */
+
+#endif /* BARRIER_H_C4C65AD7_C9F3_11F1_9F0E_C038963D1C06 */
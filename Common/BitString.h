@@ -0,0 +1,118 @@
+/*
+ * Filename: BitString.h
+ * Author:   Michael Tkach (x1mike7x@gmail.com)
+ */
+
+
+#ifndef BITSTRING_H_C4C65947_C9F3_11F1_A3A4_C038963D1C06
+#define BITSTRING_H_C4C65947_C9F3_11F1_A3A4_C038963D1C06
+
+
+#include <bitset>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "Random.h"
+
+
+namespace CleverAlgorithms
+{
+
+/*
+ * Bits packed 64 to a uint64_t word. Bits past size() in the last word are always zero, so whole-word operations
+ * need no masking. Shares size(), operator[], flip() and count() with std::bitset.
+ */
+class BitString
+{
+public:
+
+    static const size_t kWordBits = 64;
+
+
+    BitString()
+        : size_(0)
+    {
+    }
+
+    explicit BitString(const size_t size)
+        : words_((size + kWordBits - 1) / kWordBits, 0)
+        , size_(size)
+    {
+    }
+
+    /* Index of the lowest set bit of a non-zero word. */
+    static size_t lowestBit(const uint64_t word)
+    {
+        assert(word);
+
+#if defined(__GNUC__)
+        return static_cast<size_t>(__builtin_ctzll(word));
+#else
+        return std::bitset<kWordBits>((word & (~word + 1)) - 1).count();
+#endif
+    }
+
+    /* Number of set bits of a word. */
+    static size_t popCount(const uint64_t word)
+    {
+#if defined(__GNUC__)
+        return static_cast<size_t>(__builtin_popcountll(word));
+#else
+        return std::bitset<kWordBits>(word).count();
+#endif
+    }
+
+    size_t size() const
+    {
+        return size_;
+    }
+
+    bool operator[](const size_t pos) const
+    {
+        assert(pos < size_);
+
+        return (words_[pos / kWordBits] >> (pos % kWordBits)) & 1;
+    }
+
+    void flip(const size_t pos)
+    {
+        assert(pos < size_);
+
+        words_[pos / kWordBits] ^= static_cast<uint64_t>(1) << (pos % kWordBits);
+    }
+
+    size_t count() const
+    {
+        size_t res = 0;
+        for (size_t i = 0; i < words_.size(); ++i)
+        {
+            res += std::bitset<kWordBits>(words_[i]).count();
+        }
+        return res;
+    }
+
+    void randomize(Random& random)
+    {
+        random.fill(words_);
+        if (size_ % kWordBits)
+        {
+            words_.back() &= (static_cast<uint64_t>(1) << (size_ % kWordBits)) - 1;
+        }
+    }
+
+    const std::vector<uint64_t>& words() const
+    {
+        return words_;
+    }
+
+private:
+
+    std::vector<uint64_t> words_;
+    size_t size_;
+};
+
+} /* namespace CleverAlgorithms */
+
+#endif /* BITSTRING_H_C4C65947_C9F3_11F1_A3A4_C038963D1C06 */
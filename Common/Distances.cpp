@@ -0,0 +1,110 @@
+/*
+ * Filename: Distances.cpp
+ * Author:   Michael Tkach (x1mike7x@gmail.com)
+ */
+
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+#if defined(_WIN32)
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <unistd.h>
+#endif
+
+#include "Distances.h"
+#include "SpatialGrid.h"
+
+
+namespace CleverAlgorithms
+{
+
+namespace
+{
+
+const size_t kMatrixLimitBytes = size_t(128) << 20;
+
+
+inline size_t availableMemory()
+{
+#if defined(_WIN32)
+    MEMORYSTATUSEX status;
+    status.dwLength = sizeof(status);
+    if (GlobalMemoryStatusEx(&status))
+    {
+        return static_cast<size_t>(status.ullAvailPhys);
+    }
+#else
+#if defined(_SC_AVPHYS_PAGES)
+    long pages = sysconf(_SC_AVPHYS_PAGES);
+#else
+    long pages = sysconf(_SC_PHYS_PAGES);
+#endif
+    long pageSize = sysconf(_SC_PAGESIZE);
+    if (pages > 0 && pageSize > 0)
+    {
+        return static_cast<size_t>(pages) * static_cast<size_t>(pageSize);
+    }
+#endif
+    return kMatrixLimitBytes;
+}
+
+
+/* Upper bound of any edge length: the diagonal of the bounding box measured by the instance metric. */
+inline float maxDistance(const TspInstance& instance)
+{
+    if (!instance.size())
+    {
+        return 0.0f;
+    }
+    std::pair<double, double> low = instance.cities.front(),
+                              high = instance.cities.front();
+    for (size_t i = 1; i < instance.size(); ++i)
+    {
+        low.first = std::min(low.first, instance.cities[i].first);
+        low.second = std::min(low.second, instance.cities[i].second);
+        high.first = std::max(high.first, instance.cities[i].first);
+        high.second = std::max(high.second, instance.cities[i].second);
+    }
+    TspInstance corners(std::vector<std::pair<double, double>>{low, high}, instance.edgeWeightType);
+    return std::ceil(corners.distance(0, 1)) + 1.0f;
+}
+
+} /* anonymous namespace */
+
+
+NeighborLists::NeighborLists(const TspInstance& instance, const size_t kNeighborsCount)
+    : count_(instance.size() > 1 ? std::min(kNeighborsCount, instance.size() - 1) : 0)
+    , neighbors_(SpatialGrid(instance.cities).nearestNeighbors(count_))
+    , distances_(neighbors_.size())
+{
+    for (size_t i = 0; i < neighbors_.size(); ++i)
+    {
+        distances_[i] = instance.distance(static_cast<int>(i / count_), neighbors_[i]);
+    }
+}
+
+
+Distances::Policy Distances::selectPolicy(const TspInstance& instance)
+{
+    const size_t n = instance.size();
+    const size_t budget = std::min(kMatrixLimitBytes, availableMemory() / 4);
+    const bool integral = instance.edgeWeightType != TspInstance::EdgeWeightType::Euclidean;
+    const size_t cell = (integral && fitsUInt16(instance)) ? sizeof(uint16_t) : sizeof(float);
+    if (!n || n <= budget / cell / n)
+    {
+        return integral ? Policy::RoundedMatrix : Policy::Matrix;
+    }
+    return Policy::OnTheFly;
+}
+
+
+bool Distances::fitsUInt16(const TspInstance& instance)
+{
+    return maxDistance(instance) <= std::numeric_limits<uint16_t>::max();
+}
+
+} /* namespace CleverAlgorithms */
@@ -0,0 +1,188 @@
+/*
+ * Filename: Distances.h
+ * Author:   Michael Tkach (x1mike7x@gmail.com)
+ */
+
+
+#ifndef DISTANCES_H_C4C655F5_C9F3_11F1_A1D9_C038963D1C06
+#define DISTANCES_H_C4C655F5_C9F3_11F1_A1D9_C038963D1C06
+
+
+#include <cmath>
+#include <cstdint>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "TspInstance.h"
+
+
+namespace CleverAlgorithms
+{
+
+/* Full n x n matrix: float distances, or TSPLIB-rounded ones in uint16_t at half the footprint. */
+template <typename Cell>
+class MatrixDistances
+{
+public:
+
+    explicit MatrixDistances(const TspInstance& instance);
+
+    float operator()(const int a, const int b) const
+    {
+        return static_cast<float>(matrix_[static_cast<size_t>(a) * size_ + b]);
+    }
+
+    size_t size() const
+    {
+        return size_;
+    }
+
+    const TspInstance& instance() const
+    {
+        return instance_;
+    }
+
+private:
+
+    const TspInstance& instance_;
+    size_t size_;
+    std::vector<Cell> matrix_;
+};
+
+
+/* Computes every distance from the coordinates: no memory beyond the instance. */
+class OnTheFlyDistances
+{
+public:
+
+    explicit OnTheFlyDistances(const TspInstance& instance)
+        : instance_(instance)
+    {
+    }
+
+    float operator()(const int a, const int b) const
+    {
+        return instance_.distance(a, b);
+    }
+
+    size_t size() const
+    {
+        return instance_.size();
+    }
+
+    const TspInstance& instance() const
+    {
+        return instance_;
+    }
+
+private:
+
+    const TspInstance& instance_;
+};
+
+
+/*
+ * The k nearest neighbours of every city, nearest first, with their distances. Neighbour-list searches read the
+ * distance by position in the list, so a candidate edge costs no lookup by city pair.
+ */
+class NeighborLists
+{
+public:
+
+    NeighborLists(const TspInstance& instance, const size_t kNeighborsCount);
+
+    size_t count() const
+    {
+        return count_;
+    }
+
+    int neighbor(const int city, const size_t i) const
+    {
+        return neighbors_[static_cast<size_t>(city) * count_ + i];
+    }
+
+    float distance(const int city, const size_t i) const
+    {
+        return distances_[static_cast<size_t>(city) * count_ + i];
+    }
+
+private:
+
+    size_t count_;
+    std::vector<int> neighbors_;
+    std::vector<float> distances_;
+};
+
+
+/*
+ * Picks the distance storage for an instance. A search is written once against the storage interface (operator(),
+ * size() and instance()) and dispatch() instantiates it for the storage picked, so no lookup branches on the policy.
+ */
+class Distances
+{
+public:
+
+    enum class Policy
+    {
+        Auto,
+        Matrix,        /* MatrixDistances<float> */
+        RoundedMatrix, /* MatrixDistances<uint16_t>, or the float matrix if the rounded distances do not fit */
+        OnTheFly       /* OnTheFlyDistances */
+    };
+
+
+    /* Picks the policy for n cities from the matrix footprint and the available physical memory. */
+    static Policy selectPolicy(const TspInstance& instance);
+
+    /* Builds the storage for the policy and returns Search::run(storage, args...), run being a static member template. */
+    template <typename Search, typename... Args>
+    static auto dispatch(const TspInstance& instance, const Policy policy, Args&&... args)
+        -> decltype(Search::run(std::declval<const OnTheFlyDistances&>(), std::forward<Args>(args)...));
+
+private:
+
+    /* Whether every TSPLIB-rounded distance of the instance fits uint16_t. */
+    static bool fitsUInt16(const TspInstance& instance);
+};
+
+
+template <typename Cell>
+MatrixDistances<Cell>::MatrixDistances(const TspInstance& instance)
+    : instance_(instance)
+    , size_(instance.size())
+    , matrix_(size_ * size_)
+{
+    for (size_t i = 0; i < size_; ++i)
+    {
+        matrix_[i * size_ + i] = 0;
+        for (size_t j = i + 1; j < size_; ++j)
+        {
+            const float d = instance_.distance(static_cast<int>(i), static_cast<int>(j));
+            const Cell cell = static_cast<Cell>(std::is_integral<Cell>::value ? std::floor(d + 0.5f) : d);
+            matrix_[i * size_ + j] = cell;
+            matrix_[j * size_ + i] = cell;
+        }
+    }
+}
+
+
+template <typename Search, typename... Args>
+auto Distances::dispatch(const TspInstance& instance, const Policy policy, Args&&... args)
+    -> decltype(Search::run(std::declval<const OnTheFlyDistances&>(), std::forward<Args>(args)...))
+{
+    const Policy selected = policy == Policy::Auto ? selectPolicy(instance) : policy;
+    if (selected == Policy::RoundedMatrix && fitsUInt16(instance))
+    {
+        return Search::run(MatrixDistances<uint16_t>(instance), std::forward<Args>(args)...);
+    }
+    if (selected == Policy::Matrix || selected == Policy::RoundedMatrix)
+    {
+        return Search::run(MatrixDistances<float>(instance), std::forward<Args>(args)...);
+    }
+    return Search::run(OnTheFlyDistances(instance), std::forward<Args>(args)...);
+}
+
+} /* namespace CleverAlgorithms */
+
+#endif /* DISTANCES_H_C4C655F5_C9F3_11F1_A1D9_C038963D1C06 */
@@ -0,0 +1,184 @@
+/*
+ * Filename: KdTree.cpp
+ * Author:   Michael Tkach (x1mike7x@gmail.com)
+ */
+
+
+#include <algorithm>
+#include <numeric>
+
+#include "KdTree.h"
+
+
+namespace CleverAlgorithms
+{
+
+namespace
+{
+
+const size_t kLeafSize = 8;
+
+
+inline double squaredDistance(const std::pair<double, double>& a, const std::pair<double, double>& b)
+{
+    double dx = a.first - b.first;
+    double dy = a.second - b.second;
+    return dx * dx + dy * dy;
+}
+
+
+template <typename Box>
+inline double squaredDistance(const Box& box, const std::pair<double, double>& point)
+{
+    const double dx = std::max(std::max(box.minX - point.first, point.first - box.maxX), 0.0);
+    const double dy = std::max(std::max(box.minY - point.second, point.second - box.maxY), 0.0);
+    return dx * dx + dy * dy;
+}
+
+} /* anonymous namespace */
+
+
+KdTree::KdTree(const std::vector<std::pair<double, double>>& cities)
+    : cities_(cities)
+    , order_(cities.size())
+    , leafOf_(cities.size())
+    , alive_(cities.size(), 1)
+{
+    std::iota(order_.begin(), order_.end(), 0);
+    if (!cities_.empty())
+    {
+        nodes_.reserve(4 * (cities_.size() / kLeafSize + 1));
+        (void)build(0, cities_.size(), -1);
+    }
+}
+
+
+int KdTree::build(const size_t begin, const size_t end, const int parent)
+{
+    Node node;
+    node.minX = node.maxX = cities_[order_[begin]].first;
+    node.minY = node.maxY = cities_[order_[begin]].second;
+    for (size_t i = begin + 1; i < end; ++i)
+    {
+        const std::pair<double, double>& city = cities_[order_[i]];
+        node.minX = std::min(node.minX, city.first);
+        node.minY = std::min(node.minY, city.second);
+        node.maxX = std::max(node.maxX, city.first);
+        node.maxY = std::max(node.maxY, city.second);
+    }
+    node.begin = begin;
+    node.end = end;
+    node.left = node.right = -1;
+    node.parent = parent;
+    node.alive = end - begin;
+
+    const int index = static_cast<int>(nodes_.size());
+    nodes_.push_back(node);
+    if (end - begin <= kLeafSize)
+    {
+        for (size_t i = begin; i < end; ++i)
+        {
+            leafOf_[order_[i]] = index;
+        }
+        return index;
+    }
+
+    const size_t middle = begin + (end - begin) / 2;
+    const std::vector<std::pair<double, double>>& cities = cities_;
+    if (node.maxX - node.minX >= node.maxY - node.minY)
+    {
+        std::nth_element(order_.begin() + begin, order_.begin() + middle, order_.begin() + end,
+                         [&cities](int a, int b) { return cities[a].first < cities[b].first; });
+    }
+    else
+    {
+        std::nth_element(order_.begin() + begin, order_.begin() + middle, order_.begin() + end,
+                         [&cities](int a, int b) { return cities[a].second < cities[b].second; });
+    }
+    const int left = build(begin, middle, index);
+    const int right = build(middle, end, index);
+    nodes_[index].left = left;
+    nodes_[index].right = right;
+    return index;
+}
+
+
+void KdTree::erase(const int city)
+{
+    if (!alive_[city])
+    {
+        return;
+    }
+    alive_[city] = 0;
+    for (int node = leafOf_[city]; node != -1; node = nodes_[node].parent)
+    {
+        --nodes_[node].alive;
+    }
+}
+
+
+void KdTree::reset()
+{
+    std::fill(alive_.begin(), alive_.end(), 1);
+    for (size_t i = 0; i < nodes_.size(); ++i)
+    {
+        nodes_[i].alive = nodes_[i].end - nodes_[i].begin;
+    }
+}
+
+
+void KdTree::nearest(const std::pair<double, double>& point, const size_t k, std::vector<std::pair<float, int>>& result) const
+{
+    result.clear();
+    if (!k || !alive())
+    {
+        return;
+    }
+    search(0, point, k, result);
+    std::sort_heap(result.begin(), result.end());
+}
+
+
+void KdTree::search(const int index, const std::pair<double, double>& point, const size_t k, std::vector<std::pair<float, int>>& heap) const
+{
+    const Node& node = nodes_[index];
+    if (!node.alive)
+    {
+        return;
+    }
+    if (heap.size() == k && squaredDistance(node, point) >= heap.front().first)
+    {
+        return;
+    }
+
+    if (node.left == -1)
+    {
+        for (size_t i = node.begin; i < node.end; ++i)
+        {
+            const int city = order_[i];
+            if (!alive_[city])
+            {
+                continue;
+            }
+            const float d = static_cast<float>(squaredDistance(point, cities_[city]));
+            if (heap.size() < k)
+            {
+                heap.push_back({d, city});
+                std::push_heap(heap.begin(), heap.end());
+            }
+            else if (d < heap.front().first)
+            {
+                std::pop_heap(heap.begin(), heap.end());
+                heap.back() = {d, city};
+                std::push_heap(heap.begin(), heap.end());
+            }
+        }
+        return;
+    }
+
+    const bool leftFirst = squaredDistance(nodes_[node.left], point) <= squaredDistance(nodes_[node.right], point);
+    search(leftFirst ? node.left : node.right, point, k, heap);
+    search(leftFirst ? node.right : node.left, point, k, heap);
+}
+
+} /* namespace CleverAlgorithms */
@@ -0,0 +1,69 @@
+/*
+ * Filename: KdTree.h
+ * Author:   Michael Tkach (x1mike7x@gmail.com)
+ */
+
+
+#ifndef KDTREE_H_C4C65660_C9F3_11F1_93C1_C038963D1C06
+#define KDTREE_H_C4C65660_C9F3_11F1_93C1_C038963D1C06
+
+
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+
+namespace CleverAlgorithms
+{
+
+/* 2-d tree over a fixed set of cities supporting deletion, so nearest queries only see the cities still alive. */
+class KdTree
+{
+public:
+
+    explicit KdTree(const std::vector<std::pair<double, double>>& cities);
+
+    void erase(const int city);
+
+    /* Makes every city alive again. */
+    void reset();
+
+    /* Fills result with up to k alive cities closest to the point as (squared distance, city), nearest first. */
+    void nearest(const std::pair<double, double>& point, const size_t k, std::vector<std::pair<float, int>>& result) const;
+
+    size_t alive() const
+    {
+        return nodes_.empty() ? 0 : nodes_.front().alive;
+    }
+
+private:
+
+    struct Node
+    {
+        double minX;
+        double minY;
+        double maxX;
+        double maxY;
+        size_t begin;
+        size_t end;
+        int left;
+        int right;
+        int parent;
+        size_t alive;
+    };
+
+
+    int build(const size_t begin, const size_t end, const int parent);
+    void search(const int node, const std::pair<double, double>& point, const size_t k, std::vector<std::pair<float, int>>& heap) const;
+
+
+    const std::vector<std::pair<double, double>>& cities_;
+    std::vector<Node> nodes_;
+    std::vector<int> order_;
+    std::vector<int> leafOf_;
+    std::vector<char> alive_;
+};
+
+} /* namespace CleverAlgorithms */
+
+#endif /* KDTREE_H_C4C65660_C9F3_11F1_93C1_C038963D1C06 */
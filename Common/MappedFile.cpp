@@ -0,0 +1,103 @@
+/*
+ * Filename: MappedFile.cpp
+ * Author:   Michael Tkach (x1mike7x@gmail.com)
+ */
+
+
+#include <cstdint>
+#include <stdexcept>
+
+#if defined(_WIN32)
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include "MappedFile.h"
+
+
+namespace CleverAlgorithms
+{
+
+MappedFile::MappedFile(const std::string& filename)
+    : data_(nullptr)
+    , size_(0)
+{
+#if defined(_WIN32)
+    HANDLE file = ::CreateFileA(filename.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+                                FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+    if (file == INVALID_HANDLE_VALUE)
+    {
+        throw std::runtime_error("Cannot open file: " + filename);
+    }
+    LARGE_INTEGER fileSize;
+    if (!::GetFileSizeEx(file, &fileSize) || static_cast<unsigned long long>(fileSize.QuadPart) > SIZE_MAX)
+    {
+        ::CloseHandle(file);
+        throw std::runtime_error("Cannot stat file: " + filename);
+    }
+    size_ = static_cast<size_t>(fileSize.QuadPart);
+    if (size_)
+    {
+        /* The view keeps the mapping alive, so both handles can be closed right away. */
+        HANDLE mapping = ::CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        void* mapped = mapping ? ::MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0) : nullptr;
+        if (mapping)
+        {
+            ::CloseHandle(mapping);
+        }
+        if (!mapped)
+        {
+            ::CloseHandle(file);
+            throw std::runtime_error("Cannot map file: " + filename);
+        }
+        data_ = static_cast<const char*>(mapped);
+    }
+    ::CloseHandle(file);
+#else
+    int fd = ::open(filename.c_str(), O_RDONLY);
+    if (fd < 0)
+    {
+        throw std::runtime_error("Cannot open file: " + filename);
+    }
+    struct stat st;
+    if (::fstat(fd, &st) != 0)
+    {
+        ::close(fd);
+        throw std::runtime_error("Cannot stat file: " + filename);
+    }
+    size_ = static_cast<size_t>(st.st_size);
+    if (size_)
+    {
+        void* mapped = ::mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (mapped == MAP_FAILED)
+        {
+            ::close(fd);
+            throw std::runtime_error("Cannot map file: " + filename);
+        }
+        ::madvise(mapped, size_, MADV_SEQUENTIAL);
+        data_ = static_cast<const char*>(mapped);
+    }
+    ::close(fd);
+#endif
+}
+
+
+MappedFile::~MappedFile()
+{
+    if (data_)
+    {
+#if defined(_WIN32)
+        ::UnmapViewOfFile(data_);
+#else
+        ::munmap(const_cast<char*>(data_), size_);
+#endif
+    }
+}
+
+} /* namespace CleverAlgorithms */
@@ -0,0 +1,55 @@
+/*
+ * Filename: MappedFile.h
+ * Author:   Michael Tkach (x1mike7x@gmail.com)
+ */
+
+
+#ifndef MAPPEDFILE_H_C4C65B21_C9F3_11F1_A7C3_C038963D1C06
+#define MAPPEDFILE_H_C4C65B21_C9F3_11F1_A7C3_C038963D1C06
+
+
+#include <cstddef>
+#include <string>
+
+
+namespace CleverAlgorithms
+{
+
+/*
+ * Read-only view of a whole file, memory mapped for sequential access; pages are loaded on demand and can be evicted
+ * again, so the file may be larger than RAM. The view starts on a page boundary.
+ */
+class MappedFile
+{
+public:
+
+    explicit MappedFile(const std::string& filename);
+    ~MappedFile();
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    const char* begin() const
+    {
+        return data_;
+    }
+
+    const char* end() const
+    {
+        return data_ + size_;
+    }
+
+    size_t size() const
+    {
+        return size_;
+    }
+
+private:
+
+    const char* data_;
+    size_t size_;
+};
+
+} /* namespace CleverAlgorithms */
+
+#endif /* MAPPEDFILE_H_C4C65B21_C9F3_11F1_A7C3_C038963D1C06 */
@@ -0,0 +1,34 @@
+/*
+ * Filename: Objectives.h
+ * Author:   Michael Tkach (x1mike7x@gmail.com)
+ */
+
+
+#ifndef OBJECTIVES_H_C4C658EA_C9F3_11F1_9718_C038963D1C06
+#define OBJECTIVES_H_C4C658EA_C9F3_11F1_9718_C038963D1C06
+
+
+#include <cstddef>
+
+
+namespace CleverAlgorithms
+{
+
+/* Sum of squares, minimal at the origin. Takes any indexable container of floats, e.g. std::vector or std::array. */
+struct SphereFunction
+{
+    template <typename Values>
+    float operator()(const Values& values) const
+    {
+        float res = 0.0f;
+        for (size_t i = 0; i < values.size(); ++i)
+        {
+            res += values[i] * values[i];
+        }
+        return res;
+    }
+};
+
+} /* namespace CleverAlgorithms */
+
+#endif /* OBJECTIVES_H_C4C658EA_C9F3_11F1_9718_C038963D1C06 */
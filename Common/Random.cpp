@@ -0,0 +1,99 @@
+/*
+ * Filename: Random.cpp
+ * Author:   Michael Tkach (x1mike7x@gmail.com)
+ */
+
+
+#include <algorithm>
+
+#include "Random.h"
+
+
+namespace CleverAlgorithms
+{
+
+namespace
+{
+
+inline uint64_t splitMix64(uint64_t& state)
+{
+    uint64_t z = (state += 0x9E3779B97F4A7C15ull);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+    return z ^ (z >> 31);
+}
+
+} /* anonymous namespace */
+
+
+Random::Random(const uint64_t seed)
+{
+    uint64_t state = seed;
+    for (int i = 0; i < 4; ++i)
+    {
+        state_[i] = splitMix64(state);
+    }
+}
+
+
+void Random::fill(float* first, float* last, const float left, const float right)
+{
+    /* Every output has 64 good bits: two 24-bit floats are cut from each. */
+    const float scale = (right - left) * (1.0f / 16777216.0f);
+    const float upper = below(left, right);
+    for (; last - first >= 2; first += 2)
+    {
+        const uint64_t bits = (*this)();
+        first[0] = std::min(upper, left + scale * static_cast<float>(static_cast<int32_t>(bits >> 40)));
+        first[1] = std::min(upper, left + scale * static_cast<float>(static_cast<int32_t>((bits >> 16) & 0xFFFFFF)));
+    }
+    if (first != last)
+    {
+        *first = std::min(upper, left + scale * static_cast<float>((*this)() >> 40));
+    }
+}
+
+
+void Random::fill(std::vector<uint64_t>& values)
+{
+    for (size_t i = 0; i < values.size(); ++i)
+    {
+        values[i] = (*this)();
+    }
+}
+
+
+Random Random::stream()
+{
+    Random result(*this);
+    jump();
+    return result;
+}
+
+
+void Random::jump()
+{
+    static const uint64_t kJump[] = {0x180EC6D33CFD0ABAull, 0xD5A61266F0C9392Cull, 0xA9582618E03FC9AAull, 0x39ABDC4529B1661Cull};
+
+    uint64_t state[4] = {0, 0, 0, 0};
+    for (int i = 0; i < 4; ++i)
+    {
+        for (int bit = 0; bit < 64; ++bit)
+        {
+            if (kJump[i] & (static_cast<uint64_t>(1) << bit))
+            {
+                for (int j = 0; j < 4; ++j)
+                {
+                    state[j] ^= state_[j];
+                }
+            }
+            (void)(*this)();
+        }
+    }
+    for (int j = 0; j < 4; ++j)
+    {
+        state_[j] = state[j];
+    }
+}
+
+} /* namespace CleverAlgorithms */
@@ -0,0 +1,118 @@
+/*
+ * Filename: Random.h
+ * Author:   Michael Tkach (x1mike7x@gmail.com)
+ */
+
+
+#ifndef RANDOM_H_C4C6585F_C9F3_11F1_A661_C038963D1C06
+#define RANDOM_H_C4C6585F_C9F3_11F1_A661_C038963D1C06
+
+
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+
+namespace CleverAlgorithms
+{
+
+/*
+ * xoshiro256** generator with an explicit seed. Not shared between threads: every thread takes its own stream().
+ * Also a UniformRandomBitGenerator, so it works with the standard distributions and std::shuffle.
+ */
+class Random
+{
+public:
+
+    typedef uint64_t result_type;
+
+
+    explicit Random(const uint64_t seed);
+
+    static constexpr result_type min()
+    {
+        return 0;
+    }
+
+    static constexpr result_type max()
+    {
+        return ~static_cast<result_type>(0);
+    }
+
+    result_type operator()()
+    {
+        const uint64_t result = rotl(state_[1] * 5, 7) * 9;
+        const uint64_t t = state_[1] << 17;
+        state_[2] ^= state_[0];
+        state_[3] ^= state_[1];
+        state_[1] ^= state_[2];
+        state_[0] ^= state_[3];
+        state_[2] ^= t;
+        state_[3] = rotl(state_[3], 45);
+        return result;
+    }
+
+    /* Unbiased integer in [0, bound) by multiply-shift with Lemire's rejection: the division runs only on the rare rejection path. */
+    uint32_t uniformInt(const uint32_t bound)
+    {
+        uint64_t product = ((*this)() >> 32) * bound;
+        if (static_cast<uint32_t>(product) < bound)
+        {
+            const uint32_t threshold = (0u - bound) % bound;
+            while (static_cast<uint32_t>(product) < threshold)
+            {
+                product = ((*this)() >> 32) * bound;
+            }
+        }
+        return static_cast<uint32_t>(product >> 32);
+    }
+
+    /* Float in [0, 1) from the top 24 bits. */
+    float uniformFloat()
+    {
+        return static_cast<float>((*this)() >> 40) * (1.0f / 16777216.0f);
+    }
+
+    /* Float in [left, right): the product may round up to right, which is then replaced by the float just below it. */
+    float uniformFloat(const float left, const float right)
+    {
+        const float result = left + (right - left) * uniformFloat();
+        return result < right ? result : below(left, right);
+    }
+
+    /* Fills values with floats uniform in [left, right). */
+    void fill(std::vector<float>& values, const float left, const float right)
+    {
+        fill(values.data(), values.data() + values.size(), left, right);
+    }
+
+    void fill(float* first, float* last, const float left, const float right);
+
+    /* Fills values with raw 64-bit outputs, e.g. for random bit strings. */
+    void fill(std::vector<uint64_t>& values);
+
+    /* Returns a copy of this generator and jumps this one 2^128 steps ahead: successive calls give non-overlapping streams. */
+    Random stream();
+
+private:
+
+    static float below(const float left, const float right)
+    {
+        return left < right ? std::nextafter(right, left) : left;
+    }
+
+    static uint64_t rotl(const uint64_t x, const int k)
+    {
+        return (x << k) | (x >> (64 - k));
+    }
+
+    void jump();
+
+
+    uint64_t state_[4];
+};
+
+} /* namespace CleverAlgorithms */
+
+#endif /* RANDOM_H_C4C6585F_C9F3_11F1_A661_C038963D1C06 */
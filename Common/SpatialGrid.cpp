@@ -0,0 +1,188 @@
+/*
+ * Filename: SpatialGrid.cpp
+ * Author:   Michael Tkach (x1mike7x@gmail.com)
+ */
+
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+
+#include "SpatialGrid.h"
+
+
+namespace CleverAlgorithms
+{
+
+namespace
+{
+
+const double kPointsPerCell = 2.0;
+
+
+inline double squaredDistance(const std::pair<double, double>& a, const std::pair<double, double>& b)
+{
+    double dx = a.first - b.first;
+    double dy = a.second - b.second;
+    return dx * dx + dy * dy;
+}
+
+} /* anonymous namespace */
+
+
+SpatialGrid::SpatialGrid(const std::vector<std::pair<double, double>>& cities)
+    : cities_(cities)
+    , minX_(0.0)
+    , minY_(0.0)
+    , cellSize_(1.0)
+    , columns_(1)
+    , rows_(1)
+{
+    if (!cities_.empty())
+    {
+        double maxX = cities_.front().first,
+               maxY = cities_.front().second;
+        minX_ = maxX;
+        minY_ = maxY;
+        for (size_t i = 1; i < cities_.size(); ++i)
+        {
+            minX_ = std::min(minX_, cities_[i].first);
+            minY_ = std::min(minY_, cities_[i].second);
+            maxX = std::max(maxX, cities_[i].first);
+            maxY = std::max(maxY, cities_[i].second);
+        }
+
+        const double width = maxX - minX_;
+        const double height = maxY - minY_;
+        const double count = static_cast<double>(cities_.size());
+        cellSize_ = std::sqrt(width * height * kPointsPerCell / count);
+        if (!(cellSize_ > 0.0))
+        {
+            cellSize_ = std::max(width, height) * kPointsPerCell / count;
+        }
+        if (!(cellSize_ > 0.0))
+        {
+            cellSize_ = 1.0;
+        }
+        columns_ = static_cast<size_t>(width / cellSize_) + 1;
+        rows_ = static_cast<size_t>(height / cellSize_) + 1;
+    }
+
+    cellStart_.assign(columns_ * rows_ + 1, 0);
+    std::vector<size_t> cells(cities_.size());
+    for (size_t i = 0; i < cities_.size(); ++i)
+    {
+        cells[i] = cellOf(cities_[i].first, cities_[i].second);
+        ++cellStart_[cells[i] + 1];
+    }
+    for (size_t c = 1; c < cellStart_.size(); ++c)
+    {
+        cellStart_[c] += cellStart_[c - 1];
+    }
+    points_.resize(cities_.size());
+    std::vector<size_t> fill(cellStart_.begin(), cellStart_.end() - 1);
+    for (size_t i = 0; i < cities_.size(); ++i)
+    {
+        points_[fill[cells[i]]++] = static_cast<int>(i);
+    }
+}
+
+
+size_t SpatialGrid::cellOf(const double x, const double y) const
+{
+    size_t column = std::min(static_cast<size_t>((x - minX_) / cellSize_), columns_ - 1);
+    size_t row = std::min(static_cast<size_t>((y - minY_) / cellSize_), rows_ - 1);
+    return row * columns_ + column;
+}
+
+
+void SpatialGrid::nearest(const int city, const size_t k, std::vector<int>& result) const
+{
+    result.clear();
+    if (!k || cities_.size() < 2)
+    {
+        return;
+    }
+
+    const std::pair<double, double>& origin = cities_[city];
+    const size_t cell = cellOf(origin.first, origin.second);
+    const long column = static_cast<long>(cell % columns_);
+    const long row = static_cast<long>(cell / columns_);
+    const long rings = static_cast<long>(std::max(columns_, rows_));
+
+    std::vector<std::pair<double, int>> heap;
+    heap.reserve(k);
+    for (long ring = 0; ring <= rings; ++ring)
+    {
+        if (heap.size() == k && ring > 0)
+        {
+            const double reach = (ring - 1) * cellSize_;
+            if (heap.front().first <= reach * reach)
+            {
+                break;
+            }
+        }
+
+        for (long r = row - ring; r <= row + ring; ++r)
+        {
+            if (r < 0 || r >= static_cast<long>(rows_))
+            {
+                continue;
+            }
+            const bool edge = r == row - ring || r == row + ring;
+            const long step = (edge || !ring) ? 1 : 2 * ring;
+            for (long c = column - ring; c <= column + ring; c += step)
+            {
+                if (c < 0 || c >= static_cast<long>(columns_))
+                {
+                    continue;
+                }
+                const size_t index = static_cast<size_t>(r) * columns_ + static_cast<size_t>(c);
+                for (size_t i = cellStart_[index]; i < cellStart_[index + 1]; ++i)
+                {
+                    const int other = points_[i];
+                    if (other == city)
+                    {
+                        continue;
+                    }
+                    const double d = squaredDistance(origin, cities_[other]);
+                    if (heap.size() < k)
+                    {
+                        heap.push_back({d, other});
+                        std::push_heap(heap.begin(), heap.end());
+                    }
+                    else if (d < heap.front().first)
+                    {
+                        std::pop_heap(heap.begin(), heap.end());
+                        heap.back() = {d, other};
+                        std::push_heap(heap.begin(), heap.end());
+                    }
+                }
+            }
+        }
+    }
+
+    std::sort_heap(heap.begin(), heap.end());
+    result.reserve(heap.size());
+    for (size_t i = 0; i < heap.size(); ++i)
+    {
+        result.push_back(heap[i].second);
+    }
+}
+
+
+std::vector<int> SpatialGrid::nearestNeighbors(const size_t k) const
+{
+    assert(k < cities_.size());
+
+    std::vector<int> res(cities_.size() * k);
+    std::vector<int> buffer;
+    for (size_t i = 0; i < cities_.size(); ++i)
+    {
+        nearest(static_cast<int>(i), k, buffer);
+        std::copy(buffer.begin(), buffer.end(), res.begin() + i * k);
+    }
+    return res;
+}
+
+} /* namespace CleverAlgorithms */
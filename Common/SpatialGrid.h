@@ -0,0 +1,53 @@
+/*
+ * Filename: SpatialGrid.h
+ * Author:   Michael Tkach (x1mike7x@gmail.com)
+ */
+
+
+#ifndef SPATIALGRID_H_C4C65545_C9F3_11F1_B07E_C038963D1C06
+#define SPATIALGRID_H_C4C65545_C9F3_11F1_B07E_C038963D1C06
+
+
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+
+namespace CleverAlgorithms
+{
+
+class SpatialGrid
+{
+public:
+
+    explicit SpatialGrid(const std::vector<std::pair<double, double>>& cities);
+
+    /* Fills result with up to k cities closest to the given one (excluding itself), nearest first. */
+    void nearest(const int city, const size_t k, std::vector<int>& result) const;
+
+    /* Returns the k nearest neighbours of every city as a flat size() x k array, nearest first. */
+    std::vector<int> nearestNeighbors(const size_t k) const;
+
+    size_t size() const
+    {
+        return cities_.size();
+    }
+
+private:
+
+    size_t cellOf(const double x, const double y) const;
+
+
+    const std::vector<std::pair<double, double>>& cities_;
+    double minX_;
+    double minY_;
+    double cellSize_;
+    size_t columns_;
+    size_t rows_;
+    std::vector<size_t> cellStart_;
+    std::vector<int> points_;
+};
+
+} /* namespace CleverAlgorithms */
+
+#endif /* SPATIALGRID_H_C4C65545_C9F3_11F1_B07E_C038963D1C06 */
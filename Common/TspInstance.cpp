@@ -0,0 +1,421 @@
+/*
+ * Filename: TspInstance.cpp
+ * Author:   Michael Tkach (x1mike7x@gmail.com)
+ */
+
+
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <stdexcept>
+
+#include "MappedFile.h"
+#include "TspInstance.h"
+
+
+namespace CleverAlgorithms
+{
+
+namespace
+{
+
+const char kBinarySignature[4] = {'T', 'S', 'P', 'D'};
+
+/* The shortest NODE_COORD_SECTION line, "1 0 0" and its line break; the last line may lack the break. */
+const size_t kMinNodeBytes = 6;
+
+/* Any decimal exponent past this already scales a double to inf or 0. */
+const int kMaxExponent = 10000;
+
+
+struct BinaryHeader
+{
+    char signature[4];
+    uint32_t edgeWeightType;
+    uint64_t count;
+};
+
+
+class TsplibParser
+{
+public:
+
+    TsplibParser(const char* begin, const char* end)
+        : pos_(begin)
+        , end_(end)
+    {
+    }
+
+    bool atEnd()
+    {
+        skipSpaces();
+        return pos_ == end_;
+    }
+
+    /* Reads the next keyword, stopping at a blank, a colon or the end of line. */
+    std::pair<const char*, size_t> keyword()
+    {
+        skipSpaces();
+        const char* start = pos_;
+        while (pos_ != end_ && *pos_ != ':' && !isBlank(*pos_) && *pos_ != '\n' && *pos_ != '\r')
+        {
+            ++pos_;
+        }
+        return {start, static_cast<size_t>(pos_ - start)};
+    }
+
+    /* Returns the rest of the line after an optional colon, trimmed. */
+    std::pair<const char*, size_t> value()
+    {
+        while (pos_ != end_ && isBlank(*pos_))
+        {
+            ++pos_;
+        }
+        if (pos_ != end_ && *pos_ == ':')
+        {
+            ++pos_;
+        }
+        while (pos_ != end_ && isBlank(*pos_))
+        {
+            ++pos_;
+        }
+        const char* start = pos_;
+        while (pos_ != end_ && *pos_ != '\n' && *pos_ != '\r')
+        {
+            ++pos_;
+        }
+        const char* last = pos_;
+        while (last != start && isBlank(last[-1]))
+        {
+            --last;
+        }
+        return {start, static_cast<size_t>(last - start)};
+    }
+
+    bool number(double& result)
+    {
+        static const double kPowers[] = {1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+                                         1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22};
+
+        skipSpaces();
+        bool negative = false;
+        if (pos_ != end_ && (*pos_ == '-' || *pos_ == '+'))
+        {
+            negative = *pos_ == '-';
+            ++pos_;
+        }
+
+        uint64_t mantissa = 0;
+        int exponent = 0;
+        int digits = 0;
+        for (; pos_ != end_ && isDigit(*pos_); ++pos_, ++digits)
+        {
+            if (mantissa < 1000000000000000000ULL)
+            {
+                mantissa = mantissa * 10 + (*pos_ - '0');
+            }
+            else if (exponent < kMaxExponent)
+            {
+                ++exponent;
+            }
+        }
+        if (pos_ != end_ && *pos_ == '.')
+        {
+            for (++pos_; pos_ != end_ && isDigit(*pos_); ++pos_, ++digits)
+            {
+                if (mantissa < 1000000000000000000ULL)
+                {
+                    mantissa = mantissa * 10 + (*pos_ - '0');
+                    --exponent;
+                }
+            }
+        }
+        if (!digits)
+        {
+            return false;
+        }
+        if (pos_ != end_ && (*pos_ == 'e' || *pos_ == 'E'))
+        {
+            ++pos_;
+            bool negativeExponent = false;
+            if (pos_ != end_ && (*pos_ == '-' || *pos_ == '+'))
+            {
+                negativeExponent = *pos_ == '-';
+                ++pos_;
+            }
+            int e = 0;
+            for (; pos_ != end_ && isDigit(*pos_); ++pos_)
+            {
+                if (e < kMaxExponent)
+                {
+                    e = e * 10 + (*pos_ - '0');
+                }
+            }
+            exponent += negativeExponent ? -e : e;
+        }
+
+        /* A zero mantissa is left alone so that 0e99999 does not become 0 * inf. */
+        double value = static_cast<double>(mantissa);
+        if (mantissa && exponent >= 0)
+        {
+            value *= exponent <= 22 ? kPowers[exponent] : std::pow(10.0, exponent);
+        }
+        else if (mantissa)
+        {
+            value /= -exponent <= 22 ? kPowers[-exponent] : std::pow(10.0, -exponent);
+        }
+        result = negative ? -value : value;
+        return true;
+    }
+
+private:
+
+    static bool isBlank(const char c)
+    {
+        return c == ' ' || c == '\t';
+    }
+
+    static bool isDigit(const char c)
+    {
+        return c >= '0' && c <= '9';
+    }
+
+    void skipSpaces()
+    {
+        while (pos_ != end_ && (isBlank(*pos_) || *pos_ == '\n' || *pos_ == '\r'))
+        {
+            ++pos_;
+        }
+    }
+
+
+    const char* pos_;
+    const char* end_;
+};
+
+
+inline bool equals(const std::pair<const char*, size_t>& token, const char* literal)
+{
+    return token.second == std::strlen(literal) && !std::memcmp(token.first, literal, token.second);
+}
+
+
+inline TspInstance::EdgeWeightType parseEdgeWeightType(const std::pair<const char*, size_t>& token)
+{
+    if (equals(token, "EUC_2D"))
+    {
+        return TspInstance::EdgeWeightType::Euc2d;
+    }
+    if (equals(token, "CEIL_2D"))
+    {
+        return TspInstance::EdgeWeightType::Ceil2d;
+    }
+    if (equals(token, "ATT"))
+    {
+        return TspInstance::EdgeWeightType::Att;
+    }
+    throw std::runtime_error("Unsupported EDGE_WEIGHT_TYPE: " + std::string(token.first, token.second));
+}
+
+
+inline TspInstance parseTsplib(const MappedFile& file, const std::string& filename)
+{
+    TsplibParser parser(file.begin(), file.end());
+
+    TspInstance instance;
+    instance.edgeWeightType = TspInstance::EdgeWeightType::Euc2d;
+    size_t dimension = 0;
+    bool coordinates = false;
+    while (!parser.atEnd())
+    {
+        std::pair<const char*, size_t> key = parser.keyword();
+        if (equals(key, "NODE_COORD_SECTION"))
+        {
+            coordinates = true;
+            break;
+        }
+        if (equals(key, "EOF"))
+        {
+            break;
+        }
+
+        std::pair<const char*, size_t> value = parser.value();
+        if (equals(key, "NAME"))
+        {
+            instance.name.assign(value.first, value.second);
+        }
+        else if (equals(key, "TYPE"))
+        {
+            if (!equals(value, "TSP"))
+            {
+                throw std::runtime_error("Unsupported TYPE: " + std::string(value.first, value.second));
+            }
+        }
+        else if (equals(key, "DIMENSION"))
+        {
+            /* Bounded by the file size before anything is allocated for it. */
+            TsplibParser number(value.first, value.first + value.second);
+            double d = 0.0;
+            if (!number.number(d) || d < 1.0 || d > static_cast<double>((file.size() + 1) / kMinNodeBytes))
+            {
+                throw std::runtime_error("Invalid DIMENSION in " + filename);
+            }
+            dimension = static_cast<size_t>(d);
+        }
+        else if (equals(key, "EDGE_WEIGHT_TYPE"))
+        {
+            instance.edgeWeightType = parseEdgeWeightType(value);
+        }
+        else if (equals(key, "NODE_COORD_TYPE"))
+        {
+            if (!equals(value, "TWOD_COORDS"))
+            {
+                throw std::runtime_error("Unsupported NODE_COORD_TYPE: " + std::string(value.first, value.second));
+            }
+        }
+    }
+
+    if (!coordinates)
+    {
+        throw std::runtime_error("NODE_COORD_SECTION is missing in " + filename);
+    }
+    if (!dimension)
+    {
+        throw std::runtime_error("DIMENSION is missing in " + filename);
+    }
+
+    instance.cities.resize(dimension);
+    std::vector<char> seen(dimension, 0);
+    for (size_t i = 0; i < dimension; ++i)
+    {
+        double index = 0.0, x = 0.0, y = 0.0;
+        if (!parser.number(index) || !parser.number(x) || !parser.number(y))
+        {
+            throw std::runtime_error("Truncated NODE_COORD_SECTION in " + filename);
+        }
+        if (!(index >= 1.0 && index <= static_cast<double>(dimension)) || index != std::floor(index))
+        {
+            throw std::runtime_error("Invalid node index in " + filename);
+        }
+        size_t node = static_cast<size_t>(index);
+        if (seen[node - 1])
+        {
+            throw std::runtime_error("Invalid node index in " + filename);
+        }
+        if (!std::isfinite(x) || !std::isfinite(y))
+        {
+            throw std::runtime_error("Invalid coordinates in " + filename);
+        }
+        seen[node - 1] = 1;
+        instance.cities[node - 1] = {x, y};
+    }
+    return instance;
+}
+
+
+inline TspInstance parseBinary(const MappedFile& file, const std::string& filename)
+{
+    BinaryHeader header;
+    if (file.size() < sizeof(header))
+    {
+        throw std::runtime_error("Truncated binary instance: " + filename);
+    }
+    std::memcpy(&header, file.begin(), sizeof(header));
+    if (std::memcmp(header.signature, kBinarySignature, sizeof(kBinarySignature)))
+    {
+        throw std::runtime_error("Not a binary instance: " + filename);
+    }
+    if (header.edgeWeightType > static_cast<uint32_t>(TspInstance::EdgeWeightType::Att))
+    {
+        throw std::runtime_error("Unsupported edge weight type in " + filename);
+    }
+    if ((file.size() - sizeof(header)) / (2 * sizeof(double)) < header.count)
+    {
+        throw std::runtime_error("Truncated binary instance: " + filename);
+    }
+
+    TspInstance instance;
+    instance.edgeWeightType = static_cast<TspInstance::EdgeWeightType>(header.edgeWeightType);
+    instance.cities.resize(static_cast<size_t>(header.count));
+    const char* data = file.begin() + sizeof(header);
+    for (size_t i = 0; i < instance.cities.size(); ++i, data += 2 * sizeof(double))
+    {
+        std::memcpy(&instance.cities[i].first, data, sizeof(double));
+        std::memcpy(&instance.cities[i].second, data + sizeof(double), sizeof(double));
+    }
+    return instance;
+}
+
+} /* anonymous namespace */
+
+
+TspInstance::TspInstance()
+    : edgeWeightType(EdgeWeightType::Euclidean)
+{
+}
+
+
+TspInstance::TspInstance(const std::vector<std::pair<float, float>>& cities, const EdgeWeightType type)
+    : edgeWeightType(type)
+    , cities(cities.begin(), cities.end())
+{
+}
+
+
+TspInstance::TspInstance(const std::vector<std::pair<double, double>>& cities, const EdgeWeightType type)
+    : edgeWeightType(type)
+    , cities(cities)
+{
+}
+
+
+TspInstance TspInstance::load(const std::string& filename)
+{
+    MappedFile file(filename);
+    const bool binary = file.size() >= sizeof(kBinarySignature) && !std::memcmp(file.begin(), kBinarySignature, sizeof(kBinarySignature));
+    return binary ? parseBinary(file, filename) : parseTsplib(file, filename);
+}
+
+
+TspInstance TspInstance::loadTsplib(const std::string& filename)
+{
+    return parseTsplib(MappedFile(filename), filename);
+}
+
+
+TspInstance TspInstance::loadBinary(const std::string& filename)
+{
+    return parseBinary(MappedFile(filename), filename);
+}
+
+
+void TspInstance::saveBinary(const std::string& filename) const
+{
+    BinaryHeader header;
+    std::memcpy(header.signature, kBinarySignature, sizeof(kBinarySignature));
+    header.edgeWeightType = static_cast<uint32_t>(edgeWeightType);
+    header.count = cities.size();
+
+    std::vector<double> coordinates(2 * cities.size());
+    for (size_t i = 0; i < cities.size(); ++i)
+    {
+        coordinates[2 * i] = cities[i].first;
+        coordinates[2 * i + 1] = cities[i].second;
+    }
+
+    FILE* out = std::fopen(filename.c_str(), "wb");
+    if (!out)
+    {
+        throw std::runtime_error("Cannot create file: " + filename);
+    }
+    bool ok = std::fwrite(&header, sizeof(header), 1, out) == 1
+           && std::fwrite(coordinates.data(), sizeof(double), coordinates.size(), out) == coordinates.size();
+    ok = !std::fclose(out) && ok;
+    if (!ok)
+    {
+        throw std::runtime_error("Cannot write file: " + filename);
+    }
+}
+
+} /* namespace CleverAlgorithms */
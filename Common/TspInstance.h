@@ -0,0 +1,83 @@
+/*
+ * Filename: TspInstance.h
+ * Author:   Michael Tkach (x1mike7x@gmail.com)
+ */
+
+
+#ifndef TSPINSTANCE_H_C4C58F6A_C9F3_11F1_B48F_C038963D1C06
+#define TSPINSTANCE_H_C4C58F6A_C9F3_11F1_B48F_C038963D1C06
+
+
+#include <cmath>
+#include <string>
+#include <utility>
+#include <vector>
+
+
+namespace CleverAlgorithms
+{
+
+/*
+ * Coordinates are kept in double, as TSPLIB computes its distances: with float, coordinates above 2^24 or with
+ * fractional digits could move an EUC_2D/ATT distance across a rounding boundary. distance() returns float, which
+ * holds the rounded distances exactly up to 2^24.
+ */
+class TspInstance
+{
+public:
+
+    enum class EdgeWeightType
+    {
+        Euclidean, /* exact floating point distance, no rounding */
+        Euc2d,
+        Ceil2d,
+        Att
+    };
+
+
+    TspInstance();
+    explicit TspInstance(const std::vector<std::pair<float, float>>& cities, const EdgeWeightType type = EdgeWeightType::Euclidean);
+    explicit TspInstance(const std::vector<std::pair<double, double>>& cities, const EdgeWeightType type = EdgeWeightType::Euclidean);
+
+    /* Detects the binary coordinate format by its signature, otherwise parses the file as TSPLIB. */
+    static TspInstance load(const std::string& filename);
+    static TspInstance loadTsplib(const std::string& filename);
+    static TspInstance loadBinary(const std::string& filename);
+    void saveBinary(const std::string& filename) const;
+
+    size_t size() const
+    {
+        return cities.size();
+    }
+
+    float distance(const int a, const int b) const
+    {
+        const double dx = cities[a].first - cities[b].first;
+        const double dy = cities[a].second - cities[b].second;
+        switch (edgeWeightType)
+        {
+            case EdgeWeightType::Euclidean:
+                return static_cast<float>(std::sqrt(dx * dx + dy * dy));
+            case EdgeWeightType::Euc2d:
+                return static_cast<float>(std::floor(std::sqrt(dx * dx + dy * dy) + 0.5));
+            case EdgeWeightType::Ceil2d:
+                return static_cast<float>(std::ceil(std::sqrt(dx * dx + dy * dy)));
+            case EdgeWeightType::Att:
+            {
+                const double r = std::sqrt((dx * dx + dy * dy) / 10.0);
+                const double t = std::floor(r + 0.5);
+                return static_cast<float>(t < r ? t + 1.0 : t);
+            }
+        }
+        return 0.0f;
+    }
+
+
+    std::string name;
+    EdgeWeightType edgeWeightType;
+    std::vector<std::pair<double, double>> cities;
+};
+
+} /* namespace CleverAlgorithms */
+
+#endif /* TSPINSTANCE_H_C4C58F6A_C9F3_11F1_B48F_C038963D1C06 */
@@ -0,0 +1,478 @@
+/*
+ * Filename: TwoLevelListTour.cpp
+ * Author:   Michael Tkach (x1mike7x@gmail.com)
+ */
+
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <cstdlib>
+
+#include "TwoLevelListTour.h"
+
+
+namespace CleverAlgorithms
+{
+
+namespace
+{
+
+const size_t kMinGroupSize = 8;
+
+} /* anonymous namespace */
+
+
+void TwoLevelListTour::assign(const std::vector<int>& permutation)
+{
+    const size_t n = permutation.size();
+    cities_.resize(n);
+    segments_.clear();
+    if (!n)
+    {
+        return;
+    }
+
+    groupSize_ = std::max(kMinGroupSize, static_cast<size_t>(std::sqrt(static_cast<double>(n))));
+    const size_t count = (n + groupSize_ - 1) / groupSize_;
+    segments_.resize(count);
+    for (size_t s = 0; s < count; ++s)
+    {
+        const size_t begin = s * groupSize_;
+        const size_t end = std::min(n, begin + groupSize_);
+        Segment& segment = segments_[s];
+        segment.reversed = false;
+        segment.first = permutation[begin];
+        segment.last = permutation[end - 1];
+        segment.next = static_cast<int>(s + 1 == count ? 0 : s + 1);
+        segment.prev = static_cast<int>(s ? s - 1 : count - 1);
+        segment.rank = static_cast<int>(s);
+        segment.size = static_cast<int>(end - begin);
+    }
+    for (size_t i = 0; i < n; ++i)
+    {
+        City& city = cities_[permutation[i]];
+        city.segment = static_cast<int>(i / groupSize_);
+        city.id = static_cast<int>(i % groupSize_);
+        city.next = permutation[i + 1 == n ? 0 : i + 1];
+        city.prev = permutation[i ? i - 1 : n - 1];
+    }
+}
+
+
+void TwoLevelListTour::permutation(std::vector<int>& result) const
+{
+    result.clear();
+    if (cities_.empty())
+    {
+        return;
+    }
+    result.reserve(cities_.size());
+    int city = head(0);
+    for (size_t i = 0; i < cities_.size(); ++i)
+    {
+        result.push_back(city);
+        city = next(city);
+    }
+}
+
+
+bool TwoLevelListTour::between(const int a, const int b, const int c) const
+{
+    const std::pair<int, int> ka(segments_[cities_[a].segment].rank, sequence(a)),
+                              kb(segments_[cities_[b].segment].rank, sequence(b)),
+                              kc(segments_[cities_[c].segment].rank, sequence(c));
+    return ka <= kc ? (ka <= kb && kb <= kc) : (ka <= kb || kb <= kc);
+}
+
+
+void TwoLevelListTour::reverse(const int a, const int b)
+{
+    if (a == b || next(b) == a)
+    {
+        return;
+    }
+
+    if (cities_[a].segment == cities_[b].segment)
+    {
+        if (sequence(a) <= sequence(b))
+        {
+            reverseInside(a, b);
+        }
+        else
+        {
+            reverseInside(next(b), prev(a));
+        }
+        return;
+    }
+
+    const int x = prev(a),
+              y = next(b);
+    splitBefore(a);
+    splitAfter(b);
+    const int first = cities_[a].segment;
+    const int last = cities_[b].segment;
+    const int count = static_cast<int>(segments_.size());
+    const int inside = (segments_[last].rank - segments_[first].rank + count) % count + 1;
+    if (2 * inside <= count)
+    {
+        reverseSegments(first, last);
+    }
+    else
+    {
+        reverseSegments(segments_[last].next, segments_[first].prev);
+    }
+
+    /*
+     * Splits shrink the segments of x, a, b and y; merging them with their neighbours where they fit in one group keeps
+     * every two neighbouring segments above groupSize_ together, so there are at most 2n / groupSize_ + 1 segments.
+     */
+    mergeAround(x);
+    mergeAround(a);
+    mergeAround(b);
+    mergeAround(y);
+}
+
+
+void TwoLevelListTour::link(const int from, const int to)
+{
+    City& f = cities_[from];
+    if (segments_[f.segment].reversed)
+    {
+        f.prev = to;
+    }
+    else
+    {
+        f.next = to;
+    }
+    City& t = cities_[to];
+    if (segments_[t.segment].reversed)
+    {
+        t.next = from;
+    }
+    else
+    {
+        t.prev = from;
+    }
+}
+
+
+void TwoLevelListTour::collect(const int from, const int to)
+{
+    buffer_.clear();
+    for (int city = from; ; city = next(city))
+    {
+        buffer_.push_back(city);
+        if (city == to)
+        {
+            break;
+        }
+    }
+}
+
+
+/* Moves the path from..to, lying at the head or at the tail of its segment, into a new neighbouring segment. */
+int TwoLevelListTour::detach(const int from, const int to, const bool atHead)
+{
+    const int p = cities_[from].segment;
+    const int x = prev(from),
+              y = next(to);
+    collect(from, to);
+
+    const int q = static_cast<int>(segments_.size());
+    Segment segment;
+    segment.reversed = false;
+    segment.first = buffer_.front();
+    segment.last = buffer_.back();
+    segment.rank = 0;
+    segment.size = static_cast<int>(buffer_.size());
+    if (atHead)
+    {
+        segment.prev = segments_[p].prev;
+        segment.next = p;
+    }
+    else
+    {
+        segment.prev = p;
+        segment.next = segments_[p].next;
+    }
+    segments_.push_back(segment);
+    segments_[segment.prev].next = q;
+    segments_[segment.next].prev = q;
+
+    Segment& rest = segments_[p];
+    rest.size -= segment.size;
+    assert(rest.size > 0);
+    if (atHead)
+    {
+        (rest.reversed ? rest.last : rest.first) = y;
+    }
+    else
+    {
+        (rest.reversed ? rest.first : rest.last) = x;
+    }
+
+    for (size_t i = 0; i < buffer_.size(); ++i)
+    {
+        cities_[buffer_[i]].segment = q;
+        cities_[buffer_[i]].id = static_cast<int>(i);
+    }
+    for (size_t i = 1; i < buffer_.size(); ++i)
+    {
+        link(buffer_[i - 1], buffer_[i]);
+    }
+    link(x, from);
+    link(to, y);
+    return q;
+}
+
+
+void TwoLevelListTour::splitBefore(const int city)
+{
+    const int p = cities_[city].segment;
+    const int first = head(p);
+    if (first == city)
+    {
+        return;
+    }
+    const int before = std::abs(sequence(city) - sequence(first));
+    if (2 * before <= segments_[p].size)
+    {
+        (void)detach(first, prev(city), true);
+    }
+    else
+    {
+        (void)detach(city, tail(p), false);
+    }
+    rerank();
+}
+
+
+void TwoLevelListTour::splitAfter(const int city)
+{
+    const int p = cities_[city].segment;
+    const int last = tail(p);
+    if (last == city)
+    {
+        return;
+    }
+    const int after = std::abs(sequence(last) - sequence(city));
+    if (2 * after <= segments_[p].size)
+    {
+        (void)detach(next(city), last, false);
+    }
+    else
+    {
+        (void)detach(head(p), city, true);
+    }
+    rerank();
+}
+
+
+void TwoLevelListTour::rerank()
+{
+    int segment = 0;
+    for (size_t rank = 0; rank < segments_.size(); ++rank)
+    {
+        segments_[segment].rank = static_cast<int>(rank);
+        segment = segments_[segment].next;
+    }
+}
+
+
+void TwoLevelListTour::mergeAround(const int city)
+{
+    const int first = head(cities_[city].segment);
+    mergeAt(prev(first), first);
+    const int last = tail(cities_[city].segment);
+    mergeAt(last, next(last));
+}
+
+
+/* Merges the segments of the neighbouring cities u and v if they are different and fit in one group together. */
+void TwoLevelListTour::mergeAt(const int u, const int v)
+{
+    const int p = cities_[u].segment,
+              q = cities_[v].segment;
+    if (p == q || segments_[p].size + segments_[q].size > static_cast<int>(groupSize_))
+    {
+        return;
+    }
+    if (next(u) == v)
+    {
+        merge(p, q);
+    }
+    else
+    {
+        merge(q, p);
+    }
+    rerank();
+}
+
+
+/* Moves the cities of the smaller of the neighbouring segments p and q = next of p into the other one. */
+void TwoLevelListTour::merge(const int p, const int q)
+{
+    if (segments_[q].size <= segments_[p].size)
+    {
+        const int tailCity = tail(p),
+                  y = next(tail(q));
+        const int id = cities_[tailCity].id;
+        const int step = segments_[p].reversed ? -1 : 1;
+        collect(head(q), tail(q));
+        for (size_t i = 0; i < buffer_.size(); ++i)
+        {
+            cities_[buffer_[i]].segment = p;
+            cities_[buffer_[i]].id = id + step * static_cast<int>(i + 1);
+        }
+        link(tailCity, buffer_.front());
+        for (size_t i = 1; i < buffer_.size(); ++i)
+        {
+            link(buffer_[i - 1], buffer_[i]);
+        }
+        link(buffer_.back(), y);
+
+        Segment& segment = segments_[p];
+        (segment.reversed ? segment.first : segment.last) = buffer_.back();
+        segment.size += segments_[q].size;
+        segment.next = segments_[q].next;
+        segments_[segment.next].prev = p;
+        erase(q);
+    }
+    else
+    {
+        const int headCity = head(q),
+                  x = prev(head(p));
+        const int id = cities_[headCity].id;
+        const int step = segments_[q].reversed ? -1 : 1;
+        collect(head(p), tail(p));
+        const size_t count = buffer_.size();
+        for (size_t i = 0; i < count; ++i)
+        {
+            cities_[buffer_[i]].segment = q;
+            cities_[buffer_[i]].id = id - step * static_cast<int>(count - i);
+        }
+        link(x, buffer_.front());
+        for (size_t i = 1; i < count; ++i)
+        {
+            link(buffer_[i - 1], buffer_[i]);
+        }
+        link(buffer_.back(), headCity);
+
+        Segment& segment = segments_[q];
+        (segment.reversed ? segment.last : segment.first) = buffer_.front();
+        segment.size += segments_[p].size;
+        segment.prev = segments_[p].prev;
+        segments_[segment.prev].next = q;
+        erase(p);
+    }
+}
+
+
+/* Drops an unlinked segment by moving the last one into its slot. */
+void TwoLevelListTour::erase(const int segment)
+{
+    const int last = static_cast<int>(segments_.size()) - 1;
+    if (segment != last)
+    {
+        Segment& moved = segments_[segment];
+        moved = segments_[last];
+        if (moved.next == last)
+        {
+            moved.next = segment;
+            moved.prev = segment;
+        }
+        segments_[moved.prev].next = segment;
+        segments_[moved.next].prev = segment;
+        for (int city = moved.first; ; city = cities_[city].next)
+        {
+            cities_[city].segment = segment;
+            if (city == moved.last)
+            {
+                break;
+            }
+        }
+    }
+    segments_.pop_back();
+}
+
+
+/* Reverses the path a..b lying inside one segment by renumbering and relinking its cities. */
+void TwoLevelListTour::reverseInside(const int a, const int b)
+{
+    const int p = cities_[a].segment;
+    const int x = prev(a),
+              y = next(b);
+    const bool atHead = head(p) == a,
+               atTail = tail(p) == b;
+    const int id = cities_[a].id;
+    const int step = segments_[p].reversed ? -1 : 1;
+    collect(a, b);
+
+    const size_t count = buffer_.size();
+    for (size_t i = 0; i < count; ++i)
+    {
+        cities_[buffer_[count - 1 - i]].id = id + step * static_cast<int>(i);
+    }
+    Segment& segment = segments_[p];
+    if (atHead)
+    {
+        (segment.reversed ? segment.last : segment.first) = b;
+    }
+    if (atTail)
+    {
+        (segment.reversed ? segment.first : segment.last) = a;
+    }
+    for (size_t i = count - 1; i > 0; --i)
+    {
+        link(buffer_[i], buffer_[i - 1]);
+    }
+    link(x, b);
+    link(a, y);
+}
+
+
+/* Reverses the order of the whole segments first..last and flips their reversal bits. */
+void TwoLevelListTour::reverseSegments(const int first, const int last)
+{
+    const int before = segments_[first].prev,
+              after = segments_[last].next;
+    const int x = tail(before),
+              y = head(after);
+
+    buffer_.clear();
+    for (int segment = first; ; segment = segments_[segment].next)
+    {
+        buffer_.push_back(segment);
+        if (segment == last)
+        {
+            break;
+        }
+    }
+
+    const size_t count = buffer_.size();
+    for (size_t i = 0; i < count / 2; ++i)
+    {
+        std::swap(segments_[buffer_[i]].rank, segments_[buffer_[count - 1 - i]].rank);
+    }
+    int previous = before;
+    for (size_t i = count; i > 0; --i)
+    {
+        Segment& segment = segments_[buffer_[i - 1]];
+        segment.reversed = !segment.reversed;
+        segment.prev = previous;
+        segments_[previous].next = buffer_[i - 1];
+        previous = buffer_[i - 1];
+    }
+    segments_[previous].next = after;
+    segments_[after].prev = previous;
+
+    link(x, head(buffer_.back()));
+    for (size_t i = count - 1; i > 0; --i)
+    {
+        link(tail(buffer_[i]), head(buffer_[i - 1]));
+    }
+    link(tail(buffer_.front()), y);
+}
+
+} /* namespace CleverAlgorithms */
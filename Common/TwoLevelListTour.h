@@ -0,0 +1,121 @@
+/*
+ * Filename: TwoLevelListTour.h
+ * Author:   Michael Tkach (x1mike7x@gmail.com)
+ */
+
+
+#ifndef TWOLEVELLISTTOUR_H_C4C6577B_C9F3_11F1_9BEE_C038963D1C06
+#define TWOLEVELLISTTOUR_H_C4C6577B_C9F3_11F1_9BEE_C038963D1C06
+
+
+#include <cstddef>
+#include <vector>
+
+
+namespace CleverAlgorithms
+{
+
+/* Below this size the O(n) array reversal is faster than the two-level list (see Benchmarks/TourReversal). */
+const size_t kTwoLevelListMinSize = 8000;
+
+
+/*
+ * Two-level doubly-linked list (Fredman et al.): cities are grouped into about sqrt(n) segments, each with
+ * a reversal bit. next/prev/between are O(1) and reverse is O(sqrt(n)). Same interface as ArrayTour.
+ */
+class TwoLevelListTour
+{
+public:
+
+    void assign(const std::vector<int>& permutation);
+
+    void permutation(std::vector<int>& result) const;
+
+    size_t size() const
+    {
+        return cities_.size();
+    }
+
+    int next(const int city) const
+    {
+        const City& c = cities_[city];
+        return segments_[c.segment].reversed ? c.prev : c.next;
+    }
+
+    int prev(const int city) const
+    {
+        const City& c = cities_[city];
+        return segments_[c.segment].reversed ? c.next : c.prev;
+    }
+
+    /* Whether b lies on the path from a to c following next(). */
+    bool between(const int a, const int b, const int c) const;
+
+    /* Reverses the path from a to b, or the complementary one if it is shorter: the cycle is the same either way. */
+    void reverse(const int a, const int b);
+
+private:
+
+    struct City
+    {
+        int segment;
+        int id;   /* increases along the raw next links inside the segment */
+        int next; /* raw links, read in the opposite sense when the segment is reversed */
+        int prev;
+    };
+
+
+    struct Segment
+    {
+        bool reversed;
+        int first; /* raw ends, independent of the reversal bit */
+        int last;
+        int next;
+        int prev;
+        int rank;
+        int size;
+    };
+
+
+    int head(const int segment) const
+    {
+        const Segment& s = segments_[segment];
+        return s.reversed ? s.last : s.first;
+    }
+
+    int tail(const int segment) const
+    {
+        const Segment& s = segments_[segment];
+        return s.reversed ? s.first : s.last;
+    }
+
+    /* Position of the city inside its segment along the tour direction. */
+    int sequence(const int city) const
+    {
+        const City& c = cities_[city];
+        return segments_[c.segment].reversed ? -c.id : c.id;
+    }
+
+    void link(const int from, const int to);
+    void collect(const int from, const int to);
+    int detach(const int from, const int to, const bool atHead);
+    void splitBefore(const int city);
+    void splitAfter(const int city);
+    void rerank();
+    void mergeAround(const int city);
+    void mergeAt(const int u, const int v);
+    void merge(const int p, const int q);
+    void erase(const int segment);
+    void reverseInside(const int a, const int b);
+    void reverseSegments(const int first, const int last);
+
+
+    std::vector<City> cities_;
+    std::vector<Segment> segments_;
+    std::vector<int> buffer_;
+    size_t groupSize_;
+};
+
+} /* namespace CleverAlgorithms */
+
+#endif /* TWOLEVELLISTTOUR_H_C4C6577B_C9F3_11F1_9BEE_C038963D1C06 */
@@ -6,11 +6,15 @@
 
 #include <algorithm>
 #include <cassert>
-#include <cstdlib>
-#include <ctime>
-#include <set>
+#include <functional>
+#include <thread>
 
 #include "GreedyRandomizedAdaptiveSearch.h"
+#include "../Common/ArrayTour.h"
+#include "../Common/Distances.h"
+#include "../Common/KdTree.h"
+#include "../Common/Random.h"
+#include "../Common/TwoLevelListTour.h"
 
 
 namespace CleverAlgorithms
@@ -20,69 +24,78 @@ namespace CleverAlgorithms
 namespace
 {
 
-inline float euc2d(const std::pair<float, float>& a, const std::pair<float, float>& b)
-{
-    float dx = a.first - b.first;
-    float dy = a.second - b.second;
-    return std::sqrt(dx * dx + dy * dy);
-}
+/* The restricted candidate list is drawn from this many nearest unvisited cities. */
+const size_t kCandidatesCount = 8;
 
 
-inline float cost(const std::vector<std::pair<float, float>>& cities,
+template <typename DistanceTable>
+inline float cost(const DistanceTable& distances,
                   const std::vector<int>& permutation)
 {
-    assert(permutation.size() == cities.size());
+    assert(permutation.size() == distances.size());
 
     float distance = 0.0f;
-    for (size_t i = 0; i < cities.size(); ++i)
+    for (size_t i = 0; i < distances.size(); ++i)
     {
         int c1 = permutation[i];
         int c2 = i + 1 < permutation.size() ? permutation[i + 1] : permutation[0];
-        distance += euc2d(cities[c1], cities[c2]);
+        distance += distances(c1, c2);
     }
     return distance;
 }
 
 
-inline std::vector<int> stochasticTwoOpt(const std::vector<int>& permutation)
+/* Reversing the path first..last replaces the edges (prev(first), first) and (last, next(last)). */
+struct TwoOptMove
 {
-    assert(permutation.size() >= 4);
-
-    size_t c1 = rand() % permutation.size(),
-           c2 = rand() % permutation.size();
-    std::set<size_t> exclude;
-    exclude.insert(c1);
-    exclude.insert(c1 ? c1 - 1 : permutation.size() - 1);
-    exclude.insert(c1 + 1 < permutation.size() ? c1 + 1 : 0);
-    while (exclude.count(c2))
-    {
-        c2 = rand() % permutation.size();
-    }
-    if (c1 > c2)
+    int first;
+    int last;
+    float delta;
+};
+
+
+/* Draws a random 2-opt move and prices it from the four touched edges, without applying it. */
+template <typename Tour, typename DistanceTable>
+inline TwoOptMove stochasticTwoOpt(const DistanceTable& distances, const Tour& tour, Random& random)
+{
+    assert(tour.size() >= 4);
+
+    const uint32_t n = static_cast<uint32_t>(tour.size());
+    const int b = random.uniformInt(n);
+    const int a = tour.prev(b),
+              next = tour.next(b);
+    int d = random.uniformInt(n);
+    while (d == b || d == a || d == next)
     {
-        std::swap(c1, c2);
+        d = random.uniformInt(n);
     }
+    const int c = tour.prev(d);
 
-    std::vector<int> res(permutation);
-    std::reverse(res.begin() + c1, res.begin() + c2);
-    return res;
+    TwoOptMove move;
+    move.first = b;
+    move.last = c;
+    move.delta = distances(a, c) + distances(b, d)
+               - distances(a, b) - distances(c, d);
+    return move;
 }
 
 
+/* Samples 2-opt moves on the tour in place and applies the improving ones; a rejected sample costs four lookups. */
+template <typename Tour, typename DistanceTable>
 inline void localSearch(GreedyRandomizedAdaptiveSearch::Candidate& current,
-                        const std::vector<std::pair<float, float>>& cities,
-                        const int kNoImproveLimit)
+                        Tour& tour,
+                        const DistanceTable& distances,
+                        const int kNoImproveLimit,
+                        Random& random)
 {
+    tour.assign(current.permutation);
     int count = 0;
     while (count < kNoImproveLimit)
     {
-        GreedyRandomizedAdaptiveSearch::Candidate candidate;
-        candidate.permutation = stochasticTwoOpt(current.permutation);
-        candidate.cost = cost(cities, candidate.permutation);
-        if (candidate.cost < current.cost)
+        const TwoOptMove move = stochasticTwoOpt(distances, tour, random);
+        if (move.delta < 0.0f)
         {
-            current.permutation.swap(candidate.permutation);
-            current.cost = candidate.cost;
+            tour.reverse(move.first, move.last);
             count = 0;
         }
         else
@@ -90,89 +103,191 @@ inline void localSearch(GreedyRandomizedAdaptiveSearch::Candidate& current,
             ++count;
         }
     }
+    tour.permutation(current.permutation);
+    current.cost = cost(distances, current.permutation);
 }
 
 
-inline GreedyRandomizedAdaptiveSearch::Candidate constructRandomizedGreedySolution(const std::vector<std::pair<float, float>>& cities,
-                                                                                   const float kAlpha)
+template <typename DistanceTable>
+inline GreedyRandomizedAdaptiveSearch::Candidate constructRandomizedGreedySolution(const DistanceTable& distances,
+                                                                                   KdTree& unvisited,
+                                                                                   std::vector<std::pair<float, int>>& costs,
+                                                                                   const float kAlpha,
+                                                                                   Random& random)
 {
-    assert(!cities.empty());
+    assert(distances.size());
 
+    const std::vector<std::pair<double, double>>& cities = distances.instance().cities;
     GreedyRandomizedAdaptiveSearch::Candidate candidate;
-    candidate.permutation.push_back(rand() % cities.size());
-    std::vector<char> used(cities.size(), 0);
-    used[candidate.permutation.back()] = 1;
-    while (candidate.permutation.size() < cities.size())
+    candidate.permutation.reserve(distances.size());
+    candidate.permutation.push_back(random.uniformInt(static_cast<uint32_t>(distances.size())));
+    unvisited.reset();
+    unvisited.erase(candidate.permutation.back());
+    while (candidate.permutation.size() < distances.size())
     {
-        std::vector<std::pair<float, size_t>> costs;
-        for (size_t i = 0; i < cities.size(); ++i)
-        {
-            if (!used[i])
-            {
-                float c = euc2d(cities[candidate.permutation.back()], cities[i]);
-                costs.push_back({c, i});
-            }
-        }
+        const int last = candidate.permutation.back();
+        unvisited.nearest(cities[last], kCandidatesCount, costs);
 
         assert(!costs.empty());
 
+        for (size_t i = 0; i < costs.size(); ++i)
+        {
+            costs[i].first = distances(last, costs[i].second);
+        }
         float minCost = costs.front().first,
               maxCost = costs.front().first;
         for (size_t i = 1; i < costs.size(); ++i)
         {
-            if (costs[i].first < minCost)
-            {
-                minCost = costs[i].first;
-            }
-            if (costs[i].first > maxCost)
-            {
-                maxCost = costs[i].first;
-            }
+            minCost = std::min(minCost, costs[i].first);
+            maxCost = std::max(maxCost, costs[i].first);
         }
 
-        std::vector<size_t> rcl;
+        size_t rclSize = 0;
         for (size_t i = 0; i < costs.size(); ++i)
         {
-            float c = costs[i].first;
-            size_t j = costs[i].second;
-            if (c <= minCost + kAlpha * (maxCost - minCost))
+            if (costs[i].first <= minCost + kAlpha * (maxCost - minCost))
             {
-                rcl.push_back(j);
+                costs[rclSize++] = costs[i];
             }
         }
 
-        assert(!rcl.empty());
+        assert(rclSize);
 
-        size_t city = rcl[rand() % rcl.size()];
-        candidate.permutation.push_back(static_cast<int>(city));
-        used[city] = 1;
+        int city = costs[random.uniformInt(static_cast<uint32_t>(rclSize))].second;
+        candidate.permutation.push_back(city);
+        unvisited.erase(city);
     }
-    candidate.cost = cost(cities, candidate.permutation);
+    candidate.cost = cost(distances, candidate.permutation);
     return candidate;
 }
 
-} /* anonymous namespace */
 
+/* Runs every kStride-th restart from kFirst on and keeps the best of them in result. */
+template <typename Tour, typename DistanceTable>
+inline void restarts(const DistanceTable& distances,
+                     KdTree unvisited,
+                     const int kFirst,
+                     const int kStride,
+                     const int kIterLimit,
+                     const int kNoImproveLimit,
+                     const float kAlpha,
+                     Random random,
+                     GreedyRandomizedAdaptiveSearch::Candidate& result)
+{
+    std::vector<std::pair<float, int>> costs;
+    costs.reserve(kCandidatesCount);
 
-GreedyRandomizedAdaptiveSearch::Candidate GreedyRandomizedAdaptiveSearch::search(const std::vector<std::pair<float, float>>& cities,
-                                                                                 const int kIterLimit,
-                                                                                 const int kNoImproveLimit,
-                                                                                 const float kAlpha)
+    Tour tour;
+    result.permutation.clear();
+    for (int iter = kFirst; iter < kIterLimit; iter += kStride)
+    {
+        GreedyRandomizedAdaptiveSearch::Candidate candidate = constructRandomizedGreedySolution(distances, unvisited, costs, kAlpha, random);
+        localSearch(candidate, tour, distances, kNoImproveLimit, random);
+        if (result.permutation.empty() || candidate.cost < result.cost)
+        {
+            result.permutation.swap(candidate.permutation);
+            result.cost = candidate.cost;
+        }
+    }
+}
+
+
+/*
+ * searchParallel() for one tour type and distance storage: Distances::dispatch() instantiates run() for the storage it
+ * picks. The local search works on an ArrayTour or, from kTwoLevelListMinSize cities on, a TwoLevelListTour.
+ */
+template <typename Tour>
+struct ParallelSearch
+{
+    template <typename DistanceTable>
+    static GreedyRandomizedAdaptiveSearch::Candidate run(const DistanceTable& distances,
+                                                         const int kIterLimit,
+                                                         const int kNoImproveLimit,
+                                                         const float kAlpha,
+                                                         const unsigned kThreadsCount,
+                                                         const uint64_t kSeed);
+};
+
+
+template <typename Tour>
+template <typename DistanceTable>
+GreedyRandomizedAdaptiveSearch::Candidate ParallelSearch<Tour>::run(const DistanceTable& distances,
+                                                                    const int kIterLimit,
+                                                                    const int kNoImproveLimit,
+                                                                    const float kAlpha,
+                                                                    const unsigned kThreadsCount,
+                                                                    const uint64_t kSeed)
 {
-    srand(static_cast<unsigned>(time(nullptr)));
+    const unsigned threadsCount = std::max(1u, std::min(kThreadsCount, static_cast<unsigned>(kIterLimit)));
+    Random random(kSeed);
+
+    const KdTree unvisited(distances.instance().cities);
+    std::vector<GreedyRandomizedAdaptiveSearch::Candidate> results(threadsCount);
+    std::vector<std::thread> workers;
+    workers.reserve(threadsCount - 1);
+    const Random mainRandom = random.stream();
+    for (unsigned i = 1; i < threadsCount; ++i)
+    {
+        workers.emplace_back(restarts<Tour, DistanceTable>, std::cref(distances), unvisited, static_cast<int>(i),
+                             static_cast<int>(threadsCount), kIterLimit, kNoImproveLimit, kAlpha, random.stream(), std::ref(results[i]));
+    }
+    restarts<Tour>(distances, unvisited, 0, static_cast<int>(threadsCount), kIterLimit, kNoImproveLimit, kAlpha, mainRandom, results[0]);
+    for (size_t i = 0; i < workers.size(); ++i)
+    {
+        workers[i].join();
+    }
 
     GreedyRandomizedAdaptiveSearch::Candidate best;
-    for (int iter = 0; iter < kIterLimit; ++iter)
+    for (size_t i = 0; i < results.size(); ++i)
     {
-        GreedyRandomizedAdaptiveSearch::Candidate candidate = constructRandomizedGreedySolution(cities, kAlpha);
-        localSearch(candidate, cities, kNoImproveLimit);
-        if (!iter || candidate.cost < best.cost)
+        if (!results[i].permutation.empty() && (best.permutation.empty() || results[i].cost < best.cost))
         {
-            best.permutation.swap(candidate.permutation);
-            best.cost = candidate.cost;
+            best.permutation.swap(results[i].permutation);
+            best.cost = results[i].cost;
         }
     }
     return best;
 }
 
+} /* anonymous namespace */
+
+
+GreedyRandomizedAdaptiveSearch::Candidate GreedyRandomizedAdaptiveSearch::search(const std::vector<std::pair<float, float>>& cities,
+                                                                                 const int kIterLimit,
+                                                                                 const int kNoImproveLimit,
+                                                                                 const float kAlpha,
+                                                                                 const uint64_t kSeed)
+{
+    return search(TspInstance(cities), kIterLimit, kNoImproveLimit, kAlpha, kSeed);
+}
+
+
+GreedyRandomizedAdaptiveSearch::Candidate GreedyRandomizedAdaptiveSearch::search(const TspInstance& instance,
+                                                                                 const int kIterLimit,
+                                                                                 const int kNoImproveLimit,
+                                                                                 const float kAlpha,
+                                                                                 const uint64_t kSeed)
+{
+    return searchParallel(instance, kIterLimit, kNoImproveLimit, kAlpha, 1, kSeed);
+}
+
+
+GreedyRandomizedAdaptiveSearch::Candidate GreedyRandomizedAdaptiveSearch::searchParallel(const TspInstance& instance,
+                                                                                         const int kIterLimit,
+                                                                                         const int kNoImproveLimit,
+                                                                                         const float kAlpha,
+                                                                                         const unsigned kThreadsCount,
+                                                                                         const uint64_t kSeed)
+{
+    assert(kIterLimit > 0);
+
+    if (instance.size() >= kTwoLevelListMinSize)
+    {
+        return Distances::dispatch<ParallelSearch<TwoLevelListTour>>(instance, Distances::Policy::Auto, kIterLimit, kNoImproveLimit, kAlpha,
+                                                                     kThreadsCount, kSeed);
+    }
+    return Distances::dispatch<ParallelSearch<ArrayTour>>(instance, Distances::Policy::Auto, kIterLimit, kNoImproveLimit, kAlpha,
+                                                          kThreadsCount, kSeed);
+}
+
 } /* namespace CleverAlgorithms */
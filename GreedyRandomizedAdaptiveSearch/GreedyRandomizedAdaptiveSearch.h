@@ -8,8 +8,11 @@
 #define GREEDYRANDOMIZEDADAPTIVESEARCH_H_3A2344A8_2FDE_11E5_A4B9_C038963D1C06
 
 
+#include <cstdint>
 #include <vector>
 
+#include "../Common/TspInstance.h"
+
 
 namespace CleverAlgorithms
 {
@@ -28,7 +31,22 @@ public:
     static Candidate search(const std::vector<std::pair<float, float>>& cities,
                             const int kIterLimit,
                             const int kNoImproveLimit,
-                            const float kAlpha);
+                            const float kAlpha,
+                            const uint64_t kSeed);
+
+    static Candidate search(const TspInstance& instance,
+                            const int kIterLimit,
+                            const int kNoImproveLimit,
+                            const float kAlpha,
+                            const uint64_t kSeed);
+
+    /* Spreads the restarts round-robin across kThreadsCount threads, each with its own random stream. */
+    static Candidate searchParallel(const TspInstance& instance,
+                                    const int kIterLimit,
+                                    const int kNoImproveLimit,
+                                    const float kAlpha,
+                                    const unsigned kThreadsCount,
+                                    const uint64_t kSeed);
 };
 
 } /* namespace CleverAlgorithms */
@@ -5,7 +5,10 @@
 
 
 #include <cassert>
+#include <ctime>
+#include <exception>
 #include <iostream>
+#include <thread>
 
 #include "GreedyRandomizedAdaptiveSearch.h"
 
@@ -13,7 +16,7 @@
 namespace
 {
 
-inline void printResult(const std::vector<std::pair<float, float>>& cities,
+inline void printResult(const std::vector<std::pair<double, double>>& cities,
                         const CleverAlgorithms::GreedyRandomizedAdaptiveSearch::Candidate& result)
 {
     assert(cities.size() == result.permutation.size());
@@ -35,7 +38,7 @@ inline void printResult(const std::vector<std::pair<float, float>>& cities,
 } /* anonymous namespace */
 
 
-int main()
+int main(int argc, char* argv[])
 {
     std::vector<std::pair<float, float>> berlin52 = { std::make_pair(565.0f, 575.0f), std::make_pair(25.0f, 185.0f),
         std::make_pair(345.0f, 750.0f), std::make_pair(945.0f, 685.0f), std::make_pair(845.0f, 655.0f), std::make_pair(880.0f, 660.0f),
@@ -51,15 +54,32 @@ int main()
         std::make_pair(875.0f, 920.0f), std::make_pair(700.0f, 500.0f), std::make_pair(555.0f, 815.0f), std::make_pair(830.0f, 485.0f),
         std::make_pair(1170.0f, 65.0f), std::make_pair(830.0f, 610.0f), std::make_pair(605.0f, 625.0f), std::make_pair(595.0f, 360.0f),
         std::make_pair(1340.0f, 725.0f), std::make_pair(1740.0f, 245.0f) };
+    CleverAlgorithms::TspInstance instance(berlin52);
+    if (argc > 1)
+    {
+        try
+        {
+            instance = CleverAlgorithms::TspInstance::load(argv[1]);
+        }
+        catch (const std::exception& e)
+        {
+            std::cerr << e.what() << "\n";
+            return 1;
+        }
+    }
     const int kNoImproveLimit = 75;
     const int kIterLimit = 500;
     const float kAlpha = 0.35f;
+    const unsigned kThreadsCount = std::thread::hardware_concurrency();
+    const uint64_t kSeed = static_cast<uint64_t>(time(nullptr));
 
-    CleverAlgorithms::GreedyRandomizedAdaptiveSearch::Candidate result = CleverAlgorithms::GreedyRandomizedAdaptiveSearch::search(berlin52,
-                                                                                                                                  kIterLimit,
-                                                                                                                                  kNoImproveLimit,
-                                                                                                                                  kAlpha);
-    printResult(berlin52, result);
+    CleverAlgorithms::GreedyRandomizedAdaptiveSearch::Candidate result = CleverAlgorithms::GreedyRandomizedAdaptiveSearch::searchParallel(instance,
+                                                                                                                                          kIterLimit,
+                                                                                                                                          kNoImproveLimit,
+                                                                                                                                          kAlpha,
+                                                                                                                                          kThreadsCount,
+                                                                                                                                          kSeed);
+    printResult(instance.cities, result);
     return 0;
 }
 
@@ -6,12 +6,17 @@
 
 #include <algorithm>
 #include <cassert>
-#include <cstdlib>
-#include <ctime>
+#include <cmath>
+#include <cstdint>
 #include <limits>
-#include <set>
+#include <numeric>
 
 #include "GuidedLocalSearch.h"
+#include "../Common/ActiveCities.h"
+#include "../Common/ArrayTour.h"
+#include "../Common/Distances.h"
+#include "../Common/Random.h"
+#include "../Common/TwoLevelListTour.h"
 
 
 namespace CleverAlgorithms
@@ -20,62 +25,130 @@ namespace CleverAlgorithms
 namespace
 {
 
-inline float euc2d(const std::pair<float, float>& a, const std::pair<float, float>& b)
-{
-    float dx = a.first - b.first;
-    float dy = a.second - b.second;
-    return std::sqrt(dx * dx + dy * dy);
-}
+const float kEpsilon = 1e-6f;
+const uint64_t kEmptyEdge = ~static_cast<uint64_t>(0);
+const unsigned kInitialPenaltiesBits = 10;
+const size_t kInitialPenaltiesCapacity = static_cast<size_t>(1) << kInitialPenaltiesBits;
 
 
-inline std::vector<int> randomPermutation(const std::vector<std::pair<float, float>>& cities)
+/*
+ * Penalties of the penalized edges only, in an open-addressing hash table keyed on the (min, max) city pair:
+ * memory grows with the number of penalized edges instead of n^2.
+ */
+class EdgePenalties
 {
-    std::vector<int> res(cities.size());
-    std::iota(res.begin(), res.end(), 0);
-    for (size_t i = 0; i < res.size(); ++i)
+public:
+
+    EdgePenalties()
+        : keys_(kInitialPenaltiesCapacity, kEmptyEdge)
+        , values_(kInitialPenaltiesCapacity, 0.0f)
+        , count_(0)
+        , shift_(64 - kInitialPenaltiesBits)
     {
-        size_t r = rand() % (res.size() - i) + i;
-        std::swap(res[i], res[r]);
     }
-    return res;
-}
 
+    float operator()(const int a, const int b) const
+    {
+        const uint64_t key = edge(a, b);
+        for (size_t i = slot(key); ; i = (i + 1) & (keys_.size() - 1))
+        {
+            if (keys_[i] == key)
+            {
+                return values_[i];
+            }
+            if (keys_[i] == kEmptyEdge)
+            {
+                return 0.0f;
+            }
+        }
+    }
 
-inline std::vector<int> stochasticTwoOpt(const std::vector<int>& permutation)
-{
-    assert(permutation.size() >= 4);
+    void increment(const int a, const int b)
+    {
+        if (2 * (count_ + 1) > keys_.size())
+        {
+            grow();
+        }
+        const uint64_t key = edge(a, b);
+        size_t i = slot(key);
+        while (keys_[i] != key && keys_[i] != kEmptyEdge)
+        {
+            i = (i + 1) & (keys_.size() - 1);
+        }
+        if (keys_[i] == kEmptyEdge)
+        {
+            keys_[i] = key;
+            ++count_;
+        }
+        values_[i] += 1.0f;
+    }
 
-    std::set<size_t> exclude;
-    size_t c1 = rand() % permutation.size(), c2 = 0;
+private:
 
-    exclude.insert(c1);
-    exclude.insert((c1 ? c1 : permutation.size()) - 1);
-    exclude.insert((c1 + 1) % permutation.size());
+    static uint64_t edge(const int a, const int b)
+    {
+        const uint32_t lo = static_cast<uint32_t>(std::min(a, b)),
+                       hi = static_cast<uint32_t>(std::max(a, b));
+        return (static_cast<uint64_t>(lo) << 32) | hi;
+    }
 
-    do
+    size_t slot(const uint64_t key) const
     {
-        c2 = rand() % permutation.size();
+        return static_cast<size_t>((key * 0x9E3779B97F4A7C15ull) >> shift_);
     }
-    while (exclude.count(c2));
 
-    if (c1 > c2)
+    void grow()
     {
-        std::swap(c1, c2);
+        std::vector<uint64_t> keys(2 * keys_.size(), kEmptyEdge);
+        std::vector<float> values(keys.size(), 0.0f);
+        keys.swap(keys_);
+        values.swap(values_);
+        --shift_;
+        for (size_t j = 0; j < keys.size(); ++j)
+        {
+            if (keys[j] == kEmptyEdge)
+            {
+                continue;
+            }
+            size_t i = slot(keys[j]);
+            while (keys_[i] != kEmptyEdge)
+            {
+                i = (i + 1) & (keys_.size() - 1);
+            }
+            keys_[i] = keys[j];
+            values_[i] = values[j];
+        }
     }
 
-    std::vector<int> res(permutation);
-    std::reverse(res.begin() + c1, res.begin() + c2);
+
+    std::vector<uint64_t> keys_;
+    std::vector<float> values_;
+    size_t count_;
+    unsigned shift_;
+};
+
+
+template <typename DistanceTable>
+inline std::vector<int> randomPermutation(const DistanceTable& distances, Random& random)
+{
+    std::vector<int> res(distances.size());
+    std::iota(res.begin(), res.end(), 0);
+    for (size_t i = 0; i < res.size(); ++i)
+    {
+        size_t r = random.uniformInt(static_cast<uint32_t>(res.size() - i)) + i;
+        std::swap(res[i], res[r]);
+    }
     return res;
 }
 
 
-inline std::pair<float, float> augmentedCost(const std::vector<std::pair<float, float>>& cities,
+template <typename DistanceTable>
+inline std::pair<float, float> augmentedCost(const DistanceTable& distances,
                                              const std::vector<int>& permutation,
-                                             const std::vector<std::vector<float>>& penalties,
+                                             const EdgePenalties& penalties,
                                              const float kLambda)
 {
-    assert(cities.size() == permutation.size());
-    assert(cities.size() == penalties.size());
+    assert(distances.size() == permutation.size());
 
     float distance = 0.0f;
     float augmented = 0.0f;
@@ -83,126 +156,231 @@ inline std::pair<float, float> augmentedCost(const std::vector<std::pair<float,
     {
         int c1 = permutation[i];
         int c2 = (i + 1 < permutation.size()) ? permutation[i + 1] : permutation[0];
-        if (c2 < c1)
-        {
-            std::swap(c1, c2);
-        }
-        float d = euc2d(cities[c1], cities[c2]);
+        float d = distances(c1, c2);
         distance += d;
-        augmented += d * (kLambda * penalties[c1][c2]);
+        augmented += d + kLambda * penalties(c1, c2);
     }
     return {distance, augmented};
 }
 
 
-inline void updateCost(GuidedLocalSearch::Candidate& current,
-                       const std::vector<std::pair<float, float>>& cities,
-                       const std::vector<std::vector<float>>& penalties,
-                       const float kLambda)
-{
-    std::pair<float, float> costs = augmentedCost(cities, current.permutation, penalties, kLambda);
-    current.ordinaryCost = costs.first;
-    current.augmentedCost = costs.second;
-}
-
-
-inline void localSearch(GuidedLocalSearch::Candidate& current,
-                        const std::vector<std::pair<float, float>>& cities,
-                        const std::vector<std::vector<float>>& penalties,
-                        const int kNoImproveLimit,
-                        const float kLambda)
+/*
+ * Tries the 2-opt moves that add an edge from a to one of its nearest neighbours and applies the first one that
+ * improves the augmented cost. Both deltas come from the four touched edges only.
+ */
+template <typename Tour, typename DistanceTable>
+inline bool improveCity(Tour& tour,
+                        GuidedLocalSearch::Candidate& current,
+                        const DistanceTable& distances,
+                        const NeighborLists& neighbors,
+                        const EdgePenalties& penalties,
+                        const float kLambda,
+                        const int a,
+                        ActiveCities& active)
 {
-    updateCost(current, cities, penalties, kLambda);
-    int count = 0;
-    while (count < kNoImproveLimit)
+    for (int direction = 0; direction < 2; ++direction)
     {
-        GuidedLocalSearch::Candidate candidate;
-        candidate.permutation = stochasticTwoOpt(current.permutation);
-        updateCost(candidate, cities, penalties, kLambda);
-        if (candidate.augmentedCost < current.augmentedCost)
+        const bool forward = !direction;
+        const int b = forward ? tour.next(a) : tour.prev(a);
+        const float dab = distances(a, b);
+        const float pab = penalties(a, b);
+        for (size_t i = 0; i < neighbors.count(); ++i)
         {
-            current.permutation.swap(candidate.permutation);
-            current.ordinaryCost = candidate.ordinaryCost;
-            current.augmentedCost = candidate.augmentedCost;
-            count = 0;
-        }
-        else
-        {
-            ++count;
+            const int c = neighbors.neighbor(a, i);
+            const int d = forward ? tour.next(c) : tour.prev(c);
+            if (c == b || d == a)
+            {
+                continue;
+            }
+            const float dcd = distances(c, d);
+            const float delta = neighbors.distance(a, i) + distances(b, d) - dab - dcd;
+            const float augmentedDelta = delta + kLambda * (penalties(a, c) + penalties(b, d) - pab - penalties(c, d));
+            if (augmentedDelta < -kEpsilon * (dab + dcd))
+            {
+                if (forward)
+                {
+                    tour.reverse(b, c);
+                }
+                else
+                {
+                    tour.reverse(a, d);
+                }
+                current.ordinaryCost += delta;
+                current.augmentedCost += augmentedDelta;
+                active.push(a);
+                active.push(b);
+                active.push(c);
+                active.push(d);
+                return true;
+            }
         }
     }
+    return false;
 }
 
 
-inline std::vector<float> calcualateFeaturesUtilities(const std::vector<std::pair<float, float>>& cities,
-                                                      const std::vector<int>& permutation,
-                                                      const std::vector<std::vector<float>>& penalties)
+/* Fast local search: only the sub-neighbourhoods of active cities are scanned. */
+template <typename Tour, typename DistanceTable>
+inline void localSearch(Tour& tour,
+                        GuidedLocalSearch::Candidate& current,
+                        const DistanceTable& distances,
+                        const NeighborLists& neighbors,
+                        const EdgePenalties& penalties,
+                        const float kLambda,
+                        ActiveCities& active)
 {
-    assert(cities.size() == permutation.size());
-    assert(cities.size() == penalties.size());
-
-    std::vector<float> utilities(cities.size(), 0.0f);
-    for (size_t i = 0; i < permutation.size(); ++i)
+    while (!active.empty())
     {
-        int c1 = permutation[i];
-        int c2 = (i + 1 < permutation.size()) ? permutation[i + 1] : 0;
-        if (c2 < c1)
-        {
-            std::swap(c1, c2);
-        }
-        utilities[i] = euc2d(cities[c1], cities[c2]) / (1.0f + penalties[c1][c2]);
+        int a = active.pop();
+        (void)improveCity(tour, current, distances, neighbors, penalties, kLambda, a, active);
     }
-    return utilities;
 }
 
 
-inline void updatePenalties(std::vector<std::vector<float>>& penalties,
-                            const std::vector<std::pair<float, float>>& cities,
-                            const std::vector<int>& permutation,
-                            const std::vector<float>& utilities)
+/*
+ * Penalizes the tour edges of maximal utility and activates their endpoints. One walk along the tour keeps the edges
+ * within epsilon of the running maximum as (utility, first city) pairs; no permutation of the tour is needed.
+ */
+template <typename Tour, typename DistanceTable>
+inline void updatePenalties(const Tour& tour,
+                            const DistanceTable& distances,
+                            EdgePenalties& penalties,
+                            GuidedLocalSearch::Candidate& current,
+                            const float kLambda,
+                            ActiveCities& active,
+                            std::vector<std::pair<float, int>>& candidates)
 {
-    float maxUtility = *std::max_element(utilities.begin(), utilities.end());
-    for (size_t i = 0; i < permutation.size(); ++i)
+    assert(distances.size() == tour.size());
+
+    const float kUtilityEpsilon = std::numeric_limits<float>::epsilon();
+    candidates.clear();
+    float maxUtility = 0.0f;
+    int c1 = 0;
+    for (size_t i = 0; i < tour.size(); ++i)
     {
-        int c1 = permutation[i];
-        int c2 = (i + 1 < permutation.size()) ? permutation[i + 1] : 0;
-        if (c2 < c1)
+        int c2 = tour.next(c1);
+        float utility = distances(c1, c2) / (1.0f + penalties(c1, c2));
+        if (candidates.empty() || utility - maxUtility > kUtilityEpsilon)
+        {
+            candidates.clear();
+        }
+        if (candidates.empty() || utility > maxUtility)
+        {
+            maxUtility = utility;
+        }
+        if (maxUtility - utility <= kUtilityEpsilon)
         {
-            std::swap(c1, c2);
+            candidates.emplace_back(utility, c1);
         }
-        if (std::fabs(utilities[i] - maxUtility) <= std::numeric_limits<float>::epsilon())
+        c1 = c2;
+    }
+    for (size_t i = 0; i < candidates.size(); ++i)
+    {
+        if (std::fabs(candidates[i].first - maxUtility) <= kUtilityEpsilon)
         {
-            penalties[c1][c2] += 1.0f;
+            int city = candidates[i].second;
+            int next = tour.next(city);
+            penalties.increment(city, next);
+            current.augmentedCost += kLambda;
+            active.push(city);
+            active.push(next);
         }
     }
 }
 
-} /* anonymous namespace */
-
 
-GuidedLocalSearch::Candidate GuidedLocalSearch::search(const std::vector<std::pair<float, float>>& cities,
-                                                       const int kIterLimit,
-                                                       const int kNoImproveLimit,
-                                                       const float kLambda)
+template <typename Tour, typename DistanceTable>
+inline GuidedLocalSearch::Candidate guidedSearch(const DistanceTable& distances,
+                                                 const NeighborLists& neighbors,
+                                                 const int kIterLimit,
+                                                 const float kLambda,
+                                                 Random& random)
 {
-    srand(static_cast<unsigned>(time(nullptr)));
-
-    std::vector<std::vector<float>> penalties(cities.size(), std::vector<float>(cities.size(), 0.0f));
+    EdgePenalties penalties;
+    ActiveCities active(distances.size());
     GuidedLocalSearch::Candidate current, best;
-    current.permutation = randomPermutation(cities);
+    current.permutation = randomPermutation(distances, random);
+    std::pair<float, float> costs = augmentedCost(distances, current.permutation, penalties, kLambda);
+    current.ordinaryCost = costs.first;
+    current.augmentedCost = costs.second;
+    for (size_t i = 0; i < current.permutation.size(); ++i)
+    {
+        active.push(current.permutation[i]);
+    }
+
+    Tour tour;
+    tour.assign(current.permutation);
+    std::vector<std::pair<float, int>> candidates;
     for (int iter = 0; iter < kIterLimit; ++iter)
     {
-        localSearch(current, cities, penalties, kNoImproveLimit, kLambda);
-        std::vector<float> utilities = calcualateFeaturesUtilities(cities, current.permutation, penalties);
-        updatePenalties(penalties, cities, current.permutation, utilities);
+        localSearch(tour, current, distances, neighbors, penalties, kLambda, active);
+        updatePenalties(tour, distances, penalties, current, kLambda, active, candidates);
         if (!iter || current.ordinaryCost < best.ordinaryCost)
         {
-            best.permutation = current.permutation;
+            tour.permutation(best.permutation);
             best.ordinaryCost = current.ordinaryCost;
             best.augmentedCost = current.augmentedCost;
         }
     }
+
+    costs = augmentedCost(distances, best.permutation, penalties, kLambda);
+    best.ordinaryCost = costs.first;
+    best.augmentedCost = costs.second;
     return best;
 }
 
+
+/* search() for one distance storage: Distances::dispatch() instantiates run() for the storage it picks. */
+struct Search
+{
+    template <typename DistanceTable>
+    static GuidedLocalSearch::Candidate run(const DistanceTable& distances,
+                                            const NeighborLists& neighbors,
+                                            const int kIterLimit,
+                                            const float kLambda,
+                                            const uint64_t kSeed);
+};
+
+
+template <typename DistanceTable>
+GuidedLocalSearch::Candidate Search::run(const DistanceTable& distances,
+                                         const NeighborLists& neighbors,
+                                         const int kIterLimit,
+                                         const float kLambda,
+                                         const uint64_t kSeed)
+{
+    Random random(kSeed);
+
+    if (distances.size() >= kTwoLevelListMinSize)
+    {
+        return guidedSearch<TwoLevelListTour>(distances, neighbors, kIterLimit, kLambda, random);
+    }
+    return guidedSearch<ArrayTour>(distances, neighbors, kIterLimit, kLambda, random);
+}
+
+} /* anonymous namespace */
+
+
+GuidedLocalSearch::Candidate GuidedLocalSearch::search(const std::vector<std::pair<float, float>>& cities,
+                                                       const int kIterLimit,
+                                                       const size_t kNeighborsCount,
+                                                       const float kLambda,
+                                                       const uint64_t kSeed)
+{
+    return search(TspInstance(cities), kIterLimit, kNeighborsCount, kLambda, kSeed);
+}
+
+
+GuidedLocalSearch::Candidate GuidedLocalSearch::search(const TspInstance& instance,
+                                                       const int kIterLimit,
+                                                       const size_t kNeighborsCount,
+                                                       const float kLambda,
+                                                       const uint64_t kSeed)
+{
+    assert(instance.size() >= 5);
+
+    const NeighborLists neighbors(instance, kNeighborsCount);
+    return Distances::dispatch<Search>(instance, Distances::Policy::Auto, neighbors, kIterLimit, kLambda, kSeed);
+}
+
 } /* namespace CleverAlgorithms */
@@ -8,8 +8,11 @@
 #define GUIDEDLOCALSEARCH_H_51465370_2A5C_11E5_9C1D_C038963D1C06
 
 
+#include <cstdint>
 #include <vector>
 
+#include "../Common/TspInstance.h"
+
 
 namespace CleverAlgorithms
 {
@@ -26,10 +29,18 @@ public:
     };
 
 
+    /* Fast local search with 2-opt over the kNeighborsCount nearest neighbours of each city. */
     static Candidate search(const std::vector<std::pair<float, float>>& cities,
                             const int kIterLimit,
-                            const int kNoImproveLimit,
-                            const float kLambda);
+                            const size_t kNeighborsCount,
+                            const float kLambda,
+                            const uint64_t kSeed);
+
+    static Candidate search(const TspInstance& instance,
+                            const int kIterLimit,
+                            const size_t kNeighborsCount,
+                            const float kLambda,
+                            const uint64_t kSeed);
 };
 
 } /* namespace CleverAlgorithms */
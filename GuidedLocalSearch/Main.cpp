@@ -5,6 +5,8 @@
 
 
 #include <cassert>
+#include <ctime>
+#include <exception>
 #include <iostream>
 
 #include "GuidedLocalSearch.h"
@@ -13,7 +15,7 @@
 namespace
 {
 
-inline void printResult(const std::vector<std::pair<float, float>>& cities,
+inline void printResult(const std::vector<std::pair<double, double>>& cities,
                         const CleverAlgorithms::GuidedLocalSearch::Candidate& result)
 {
     assert(cities.size() == result.permutation.size());
@@ -36,7 +38,7 @@ inline void printResult(const std::vector<std::pair<float, float>>& cities,
 } /* anonymous namespace */
 
 
-int main()
+int main(int argc, char* argv[])
 {
     std::vector<std::pair<float, float>> berlin52 = { std::make_pair(565.0f, 575.0f), std::make_pair(25.0f, 185.0f),
         std::make_pair(345.0f, 750.0f), std::make_pair(945.0f, 685.0f), std::make_pair(845.0f, 655.0f), std::make_pair(880.0f, 660.0f),
@@ -52,13 +54,27 @@ int main()
         std::make_pair(875.0f, 920.0f), std::make_pair(700.0f, 500.0f), std::make_pair(555.0f, 815.0f), std::make_pair(830.0f, 485.0f),
         std::make_pair(1170.0f, 65.0f), std::make_pair(830.0f, 610.0f), std::make_pair(605.0f, 625.0f), std::make_pair(595.0f, 360.0f),
         std::make_pair(1340.0f, 725.0f), std::make_pair(1740.0f, 245.0f) };
-    const int kNoImproveLimit = 50;
+    CleverAlgorithms::TspInstance instance(berlin52);
+    if (argc > 1)
+    {
+        try
+        {
+            instance = CleverAlgorithms::TspInstance::load(argv[1]);
+        }
+        catch (const std::exception& e)
+        {
+            std::cerr << e.what() << "\n";
+            return 1;
+        }
+    }
+    const size_t kNeighborsCount = 10;
     const int kIterLimit = 1000;
     const float kAlpha = 0.3f;
     const float kLocalSearchOptima = 12000.0f;
-    const float kLambda = kAlpha * kLocalSearchOptima / berlin52.size();
+    const float kLambda = kAlpha * kLocalSearchOptima / instance.size();
+    const uint64_t kSeed = static_cast<uint64_t>(time(nullptr));
 
-    CleverAlgorithms::GuidedLocalSearch::Candidate result = CleverAlgorithms::GuidedLocalSearch::search(berlin52, kIterLimit, kNoImproveLimit, kLambda);
-    printResult(berlin52, result);
+    CleverAlgorithms::GuidedLocalSearch::Candidate result = CleverAlgorithms::GuidedLocalSearch::search(instance, kIterLimit, kNeighborsCount, kLambda, kSeed);
+    printResult(instance.cities, result);
     return 0;
 }
@@ -6,11 +6,15 @@
 
 #include <algorithm>
 #include <cassert>
-#include <cstdlib>
-#include <ctime>
+#include <numeric>
 #include <set>
 
 #include "IteratedLocalSearch.h"
+#include "../Common/ActiveCities.h"
+#include "../Common/ArrayTour.h"
+#include "../Common/Distances.h"
+#include "../Common/Random.h"
+#include "../Common/TwoLevelListTour.h"
 
 
 namespace CleverAlgorithms
@@ -19,30 +23,27 @@ namespace CleverAlgorithms
 namespace
 {
 
-inline std::vector<int> randomPermutation(const std::vector<std::pair<float, float>>& cities)
+const float kEpsilon = 1e-6f;
+
+
+template <typename DistanceTable>
+inline std::vector<int> randomPermutation(const DistanceTable& distances, Random& random)
 {
-    std::vector<int> res(cities.size());
+    std::vector<int> res(distances.size());
     std::iota(res.begin(), res.end(), 0);
     for (size_t i = 0; i < res.size(); ++i)
     {
-        int r = rand() % (res.size() - i) + i;
+        int r = random.uniformInt(static_cast<uint32_t>(res.size() - i)) + i;
         std::swap(res[i], res[r]);
     }
     return res;
 }
 
 
-inline float euc2d(const std::pair<float, float>& a, const std::pair<float, float>& b)
+template <typename DistanceTable>
+inline float cost(const DistanceTable& distances, const std::vector<int>& permutation)
 {
-    float dx = a.first - b.first;
-    float dy = a.second - b.second;
-    return std::sqrt(dx * dx + dy * dy);
-}
-
-
-inline float cost(const std::vector<std::pair<float, float>>& cities, const std::vector<int>& permutation)
-{
-    assert(cities.size() == permutation.size());
+    assert(distances.size() == permutation.size());
 
     float res = 0.0f;
     for (size_t i = 0; i < permutation.size(); ++i)
@@ -50,26 +51,26 @@ inline float cost(const std::vector<std::pair<float, float>>& cities, const std:
         size_t j = i + 1;
         if (j == permutation.size()) j = 0;
 
-        res += euc2d(cities[permutation[i]], cities[permutation[j]]);
+        res += distances(permutation[i], permutation[j]);
     }
     return res;
 }
 
 
-inline std::vector<int> stochasticTwoOpt(const std::vector<int>& permutation)
+inline std::vector<int> stochasticTwoOpt(const std::vector<int>& permutation, Random& random)
 {
     assert(permutation.size() >= 4);
 
     std::set<size_t> exclude;
     size_t c1 = 0, c2 = 0;
-    c1 = rand() % permutation.size();
+    c1 = random.uniformInt(static_cast<uint32_t>(permutation.size()));
     exclude.insert(c1);
     exclude.insert((c1 ? c1 : permutation.size()) - 1);
     exclude.insert((c1 + 1 == permutation.size()) ? 0 : c1 + 1);
 
     do
     {
-        c2 = rand() % permutation.size();
+        c2 = random.uniformInt(static_cast<uint32_t>(permutation.size()));
     }
     while (exclude.count(c2));
 
@@ -84,16 +85,18 @@ inline std::vector<int> stochasticTwoOpt(const std::vector<int>& permutation)
 }
 
 
+template <typename DistanceTable>
 inline void localSearch(IteratedLocalSearch::Candidate& current,
-                        const std::vector<std::pair<float, float>>& cities,
-                        const int kNoImproveLimit)
+                        const DistanceTable& distances,
+                        const int kNoImproveLimit,
+                        Random& random)
 {
     int count = 0;
     while (count < kNoImproveLimit)
     {
         IteratedLocalSearch::Candidate candidate;
-        candidate.permutation = stochasticTwoOpt(current.permutation);
-        candidate.cost = cost(cities, candidate.permutation);
+        candidate.permutation = stochasticTwoOpt(current.permutation, random);
+        candidate.cost = cost(distances, candidate.permutation);
         if (candidate.cost < current.cost)
         {
             count = 0;
@@ -108,15 +111,15 @@ inline void localSearch(IteratedLocalSearch::Candidate& current,
 }
 
 
-inline std::vector<int> doubleBridgeMove(const std::vector<int>& permutation)
+inline std::vector<int> doubleBridgeMove(const std::vector<int>& permutation, Random& random)
 {
     assert(permutation.size() >= 4);
 
-    const size_t kRandMod = permutation.size() / 4;
+    const uint32_t kRandMod = static_cast<uint32_t>(permutation.size() / 4);
     size_t pos0 = 0;
-    size_t pos1 = 1 + rand() % kRandMod;
-    size_t pos2 = pos1 + 1 + rand() % kRandMod;
-    size_t pos3 = pos2 + 1 + rand() % kRandMod;
+    size_t pos1 = 1 + random.uniformInt(kRandMod);
+    size_t pos2 = pos1 + 1 + random.uniformInt(kRandMod);
+    size_t pos3 = pos2 + 1 + random.uniformInt(kRandMod);
     size_t pos4 = permutation.size();
 
     std::vector<int> res;
@@ -129,32 +132,253 @@ inline std::vector<int> doubleBridgeMove(const std::vector<int>& permutation)
 }
 
 
-inline IteratedLocalSearch::Candidate perturbation(const std::vector<std::pair<float, float>>& cities,
-                                                   const IteratedLocalSearch::Candidate& best)
+template <typename DistanceTable>
+inline IteratedLocalSearch::Candidate perturbation(const DistanceTable& distances,
+                                                   const IteratedLocalSearch::Candidate& best,
+                                                   Random& random)
 {
     IteratedLocalSearch::Candidate candidate;
-    candidate.permutation = doubleBridgeMove(best.permutation);
-    candidate.cost = cost(cities, candidate.permutation);
+    candidate.permutation = doubleBridgeMove(best.permutation, random);
+    candidate.cost = cost(distances, candidate.permutation);
     return candidate;
 }
 
-} /* anonymous namespace */
 
+/* A 2-opt move that replaced the tour edges (t1, t2) and (t3, t4), t2 and t4 following t1 and t3 in one direction. */
+struct TwoOptMove
+{
+    int t1;
+    int t2;
+    int t3;
+    int t4;
+};
 
-IteratedLocalSearch::Candidate IteratedLocalSearch::search(const std::vector<std::pair<float, float>>& cities,
-                                                           const int kIterLimit,
-                                                           const int kNoImproveLimit)
+
+/*
+ * Replaces the edges (t1, t2) and (t3, t4) with (t1, t3) and (t2, t4) by reversing the path t2..t3. The tour may
+ * have been reversed as a whole by an earlier move, so the direction is read from the tour.
+ */
+template <typename Tour>
+inline void exchange(Tour& tour, const int t1, const int t2, const int t3, const int t4, std::vector<TwoOptMove>& log)
+{
+    if (tour.next(t1) == t2)
+    {
+        tour.reverse(t2, t3);
+    }
+    else
+    {
+        tour.reverse(t3, t2);
+    }
+    const TwoOptMove move = {t1, t2, t3, t4};
+    log.push_back(move);
+}
+
+
+/* Undoes the logged moves, last first: the inverse of a 2-opt move is the 2-opt move on the edges it added. */
+template <typename Tour>
+inline void rollback(Tour& tour, std::vector<TwoOptMove>& log)
+{
+    while (!log.empty())
+    {
+        const TwoOptMove move = log.back();
+        log.pop_back();
+        if (tour.next(move.t1) == move.t3)
+        {
+            tour.reverse(move.t3, move.t2);
+        }
+        else
+        {
+            tour.reverse(move.t2, move.t3);
+        }
+    }
+}
+
+
+/* Tries the 2-opt moves that add an edge from a to one of its nearest neighbours; applies the first improving one. */
+template <typename Tour, typename DistanceTable>
+inline bool improveCity(Tour& tour,
+                        float& tourCost,
+                        const DistanceTable& distances,
+                        const NeighborLists& neighbors,
+                        const int a,
+                        ActiveCities& active,
+                        std::vector<TwoOptMove>& log)
+{
+    for (int direction = 0; direction < 2; ++direction)
+    {
+        const bool forward = !direction;
+        const int b = forward ? tour.next(a) : tour.prev(a);
+        const float dab = distances(a, b);
+        for (size_t i = 0; i < neighbors.count(); ++i)
+        {
+            const int c = neighbors.neighbor(a, i);
+            const float dac = neighbors.distance(a, i);
+            if (dac >= dab)
+            {
+                break;
+            }
+            const int d = forward ? tour.next(c) : tour.prev(c);
+            if (c == b || d == a)
+            {
+                continue;
+            }
+            const float dcd = distances(c, d);
+            const float delta = dac + distances(b, d) - dab - dcd;
+            if (delta < -kEpsilon * (dab + dcd))
+            {
+                exchange(tour, a, b, c, d, log);
+                tourCost += delta;
+                active.push(a);
+                active.push(b);
+                active.push(c);
+                active.push(d);
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+
+template <typename Tour, typename DistanceTable>
+inline void neighborListLocalSearch(Tour& tour,
+                                    float& tourCost,
+                                    const DistanceTable& distances,
+                                    const NeighborLists& neighbors,
+                                    ActiveCities& active,
+                                    std::vector<TwoOptMove>& log)
+{
+    while (!active.empty())
+    {
+        int a = active.pop();
+        (void)improveCity(tour, tourCost, distances, neighbors, a, active, log);
+    }
+}
+
+
+/*
+ * Applies a random double-bridge move in place, activates the eight endpoints and returns the cost change. Four
+ * random cities cut the tour into A B C D, which becomes A D C B by three reversals: A C' B' D, A C' D' B, A D C B.
+ */
+template <typename Tour, typename DistanceTable>
+inline float doubleBridgeMove(Tour& tour,
+                              const DistanceTable& distances,
+                              ActiveCities& active,
+                              Random& random,
+                              std::vector<TwoOptMove>& log)
+{
+    assert(tour.size() >= 8);
+
+    const uint32_t n = static_cast<uint32_t>(tour.size());
+    int cuts[4];
+    for (size_t i = 0; i < 4; ++i)
+    {
+        do
+        {
+            cuts[i] = random.uniformInt(n);
+        }
+        while (std::find(cuts, cuts + i, cuts[i]) != cuts + i);
+    }
+    /* Orders cuts[1..3] along the tour from cuts[0]. */
+    for (size_t i = 2; i < 4; ++i)
+    {
+        for (size_t j = i; j > 1 && tour.between(cuts[0], cuts[j], cuts[j - 1]); --j)
+        {
+            std::swap(cuts[j], cuts[j - 1]);
+        }
+    }
+
+    const int a2 = cuts[0], b1 = tour.next(a2),
+              b2 = cuts[1], c1 = tour.next(b2),
+              c2 = cuts[2], d1 = tour.next(c2),
+              d2 = cuts[3], a1 = tour.next(d2);
+    const float removed = distances(a2, b1) + distances(b2, c1) + distances(c2, d1) + distances(d2, a1);
+    const float added = distances(a2, d1) + distances(d2, c1) + distances(c2, b1) + distances(b2, a1);
+
+    exchange(tour, a2, b1, c2, d1, log);
+    exchange(tour, c1, b2, d2, a1, log);
+    exchange(tour, a2, c2, d1, b1, log);
+
+    const int endpoints[8] = {a1, a2, b1, b2, c1, c2, d1, d2};
+    for (size_t i = 0; i < 8; ++i)
+    {
+        active.push(endpoints[i]);
+    }
+    return added - removed;
+}
+
+
+/*
+ * Every kick and every local search move is applied to the one tour and logged; a kick that does not improve the
+ * tour is rolled back from the log, so an iteration costs its moves only instead of an O(n) copy of the tour.
+ */
+template <typename Tour, typename DistanceTable>
+inline IteratedLocalSearch::Candidate neighborListSearch(const DistanceTable& distances,
+                                                         const NeighborLists& neighbors,
+                                                         const int kIterLimit,
+                                                         Random& random)
+{
+    ActiveCities active(distances.size());
+    std::vector<TwoOptMove> log;
+
+    Tour tour;
+    const std::vector<int> permutation = randomPermutation(distances, random);
+    tour.assign(permutation);
+    float bestCost = cost(distances, permutation);
+    for (size_t i = 0; i < permutation.size(); ++i)
+    {
+        active.push(permutation[i]);
+    }
+    neighborListLocalSearch(tour, bestCost, distances, neighbors, active, log);
+    for (int iter = 0; iter < kIterLimit; ++iter)
+    {
+        log.clear();
+        float candidateCost = bestCost + doubleBridgeMove(tour, distances, active, random, log);
+        neighborListLocalSearch(tour, candidateCost, distances, neighbors, active, log);
+        if (candidateCost < bestCost)
+        {
+            bestCost = candidateCost;
+        }
+        else
+        {
+            rollback(tour, log);
+        }
+    }
+
+    IteratedLocalSearch::Candidate result;
+    tour.permutation(result.permutation);
+    result.cost = cost(distances, result.permutation);
+    return result;
+}
+
+
+/* search() for one distance storage: Distances::dispatch() instantiates run() for the storage it picks. */
+struct Search
+{
+    template <typename DistanceTable>
+    static IteratedLocalSearch::Candidate run(const DistanceTable& distances,
+                                              const int kIterLimit,
+                                              const int kNoImproveLimit,
+                                              const uint64_t kSeed);
+};
+
+
+template <typename DistanceTable>
+IteratedLocalSearch::Candidate Search::run(const DistanceTable& distances,
+                                           const int kIterLimit,
+                                           const int kNoImproveLimit,
+                                           const uint64_t kSeed)
 {
-    srand(static_cast<unsigned>(time(nullptr)));
+    Random random(kSeed);
 
     IteratedLocalSearch::Candidate best;
-    best.permutation = randomPermutation(cities);
-    best.cost = cost(cities, best.permutation);
-    localSearch(best, cities, kNoImproveLimit);
+    best.permutation = randomPermutation(distances, random);
+    best.cost = cost(distances, best.permutation);
+    localSearch(best, distances, kNoImproveLimit, random);
     for (int iter = 0; iter < kIterLimit; ++iter)
     {
-        IteratedLocalSearch::Candidate candidate = perturbation(cities, best);
-        localSearch(candidate, cities, kNoImproveLimit);
+        IteratedLocalSearch::Candidate candidate = perturbation(distances, best, random);
+        localSearch(candidate, distances, kNoImproveLimit, random);
         if (candidate.cost < best.cost)
         {
             best.permutation.swap(candidate.permutation);
@@ -164,4 +388,63 @@ IteratedLocalSearch::Candidate IteratedLocalSearch::search(const std::vector<std
     return best;
 }
 
+
+/* searchNeighborLists() for one distance storage. */
+struct NeighborListsSearch
+{
+    template <typename DistanceTable>
+    static IteratedLocalSearch::Candidate run(const DistanceTable& distances,
+                                              const NeighborLists& neighbors,
+                                              const int kIterLimit,
+                                              const uint64_t kSeed);
+};
+
+
+template <typename DistanceTable>
+IteratedLocalSearch::Candidate NeighborListsSearch::run(const DistanceTable& distances,
+                                                        const NeighborLists& neighbors,
+                                                        const int kIterLimit,
+                                                        const uint64_t kSeed)
+{
+    Random random(kSeed);
+
+    if (distances.size() >= kTwoLevelListMinSize)
+    {
+        return neighborListSearch<TwoLevelListTour>(distances, neighbors, kIterLimit, random);
+    }
+    return neighborListSearch<ArrayTour>(distances, neighbors, kIterLimit, random);
+}
+
+} /* anonymous namespace */
+
+
+IteratedLocalSearch::Candidate IteratedLocalSearch::search(const std::vector<std::pair<float, float>>& cities,
+                                                           const int kIterLimit,
+                                                           const int kNoImproveLimit,
+                                                           const uint64_t kSeed)
+{
+    return search(TspInstance(cities), kIterLimit, kNoImproveLimit, kSeed);
+}
+
+
+IteratedLocalSearch::Candidate IteratedLocalSearch::search(const TspInstance& instance,
+                                                           const int kIterLimit,
+                                                           const int kNoImproveLimit,
+                                                           const uint64_t kSeed)
+{
+    return Distances::dispatch<Search>(instance, Distances::Policy::Auto, kIterLimit, kNoImproveLimit, kSeed);
+}
+
+
+IteratedLocalSearch::Candidate IteratedLocalSearch::searchNeighborLists(const TspInstance& instance,
+                                                                        const int kIterLimit,
+                                                                        const size_t kNeighborsCount,
+                                                                        const uint64_t kSeed)
+{
+    assert(instance.size() >= 8);
+
+    const NeighborLists neighbors(instance, kNeighborsCount);
+    return Distances::dispatch<NeighborListsSearch>(instance, Distances::Policy::Auto, neighbors, kIterLimit, kSeed);
+}
+
 } /* namespace CleverAlgorithms */
@@ -8,8 +8,11 @@
 #define ITERATEDLOCALSEARCH_H_777FF7BE_298D_11E5_9758_C038963D1C06
 
 
+#include <cstdint>
 #include <vector>
 
+#include "../Common/TspInstance.h"
+
 
 namespace CleverAlgorithms
 {
@@ -25,7 +28,15 @@ public:
     };
 
 
-    static Candidate search(const std::vector<std::pair<float, float>>& cities, const int kIterLimit, const int kNoImproveLimit);
+    static Candidate search(const std::vector<std::pair<float, float>>& cities, const int kIterLimit, const int kNoImproveLimit, const uint64_t kSeed);
+
+    static Candidate search(const TspInstance& instance, const int kIterLimit, const int kNoImproveLimit, const uint64_t kSeed);
+
+    /*
+     * Deterministic 2-opt over the nearest neighbours of each city with don't-look bits instead of random sampling.
+     * Large instances keep the tour in a two-level list so that a reversal costs O(sqrt(n)) instead of O(n).
+     */
+    static Candidate searchNeighborLists(const TspInstance& instance, const int kIterLimit, const size_t kNeighborsCount, const uint64_t kSeed);
 };
 
 } /* namespace CleverAlgorithms */
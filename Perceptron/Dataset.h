@@ -0,0 +1,364 @@
+/*
+ * Filename: Dataset.h
+ * Author:   Michael Tkach (x1mike7x@gmail.com)
+ */
+
+
+#ifndef DATASET_H_C4C65A8C_C9F3_11F1_B2F4_C038963D1C06
+#define DATASET_H_C4C65A8C_C9F3_11F1_B2F4_C038963D1C06
+
+
+#include <atomic>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+#include "../Common/AlignedAllocator.h"
+#include "../Common/BitString.h"
+
+
+namespace CleverAlgorithms
+{
+
+/* Floats per cache line: rows are aligned and padded to this, and the dot product keeps as many partial sums. */
+const size_t kSimdLanes = 16;
+
+
+/* Dot product with kSimdLanes independent partial sums, so the compiler can keep them in vector registers. */
+inline float dotProduct(const float* weights, const float* values, const size_t count)
+{
+    float partial[kSimdLanes] = {};
+    size_t i = 0;
+    for (; i + kSimdLanes <= count; i += kSimdLanes)
+    {
+        for (size_t j = 0; j < kSimdLanes; ++j)
+        {
+            partial[j] += weights[i + j] * values[i + j];
+        }
+    }
+    float sum = 0.0f;
+    for (size_t j = 0; j < kSimdLanes; ++j)
+    {
+        sum += partial[j];
+    }
+    for (; i < count; ++i)
+    {
+        sum += weights[i] * values[i];
+    }
+    return sum;
+}
+
+
+/* weights += scale * values */
+inline void addScaled(float* weights, const float scale, const float* values, const size_t count)
+{
+    for (size_t i = 0; i < count; ++i)
+    {
+        weights[i] += scale * values[i];
+    }
+}
+
+
+/*
+ * Patterns as a row-major float matrix plus a separate label array. Every row starts on a cache line and is
+ * zero-padded to whole lines. Weight vectors hold one weight per input followed by the bias.
+ */
+class DenseDataset
+{
+public:
+
+    explicit DenseDataset(const size_t inputs)
+        : inputs_(inputs)
+        , stride_((inputs + kSimdLanes - 1) / kSimdLanes * kSimdLanes)
+    {
+    }
+
+    size_t size() const
+    {
+        return labels_.size();
+    }
+
+    size_t inputs() const
+    {
+        return inputs_;
+    }
+
+    /* Distance in floats between the starts of consecutive rows. */
+    size_t stride() const
+    {
+        return stride_;
+    }
+
+    void reserve(const size_t rows)
+    {
+        values_.reserve(rows * stride_);
+        labels_.reserve(rows);
+    }
+
+    /* Appends a pattern read from the inputs() values starting at first. */
+    template <typename Iterator>
+    void push(Iterator first, const float label)
+    {
+        values_.insert(values_.end(), first, first + inputs_);
+        values_.resize(values_.size() + stride_ - inputs_, 0.0f);
+        labels_.push_back(label);
+    }
+
+    const float* row(const size_t i) const
+    {
+        assert(i < size());
+
+        return values_.data() + i * stride_;
+    }
+
+    float label(const size_t i) const
+    {
+        return labels_[i];
+    }
+
+    float activate(const float* weights, const size_t i) const
+    {
+        return dotProduct(weights, row(i), inputs_) + weights[inputs_];
+    }
+
+    void update(float* weights, const size_t i, const float scale) const
+    {
+        addScaled(weights, scale, row(i), inputs_);
+        weights[inputs_] += scale;
+    }
+
+private:
+
+    size_t inputs_;
+    size_t stride_;
+    std::vector<float, AlignedAllocator<float, kSimdLanes * sizeof(float)>> values_;
+    std::vector<float> labels_;
+};
+
+
+/*
+ * Weight shared by Hogwild threads: relaxed loads and stores compile to plain moves, so racing updates may overwrite
+ * each other but never tear. The binary and sparse datasets accept it in place of float.
+ */
+class RelaxedFloat
+{
+public:
+
+    RelaxedFloat()
+        : value_(0.0f)
+    {
+    }
+
+    operator float() const
+    {
+        return value_.load(std::memory_order_relaxed);
+    }
+
+    RelaxedFloat& operator=(const float value)
+    {
+        value_.store(value, std::memory_order_relaxed);
+        return *this;
+    }
+
+    RelaxedFloat& operator+=(const float value)
+    {
+        value_.store(value_.load(std::memory_order_relaxed) + value, std::memory_order_relaxed);
+        return *this;
+    }
+
+private:
+
+    std::atomic<float> value_;
+};
+
+
+/*
+ * Patterns of 0/1 inputs packed 64 to a word, a row per whole number of words. Activation and updates visit only the
+ * set bits, so they never multiply and never touch the weights of inactive inputs.
+ */
+class BinaryDataset
+{
+public:
+
+    explicit BinaryDataset(const size_t inputs)
+        : inputs_(inputs)
+        , stride_((inputs + BitString::kWordBits - 1) / BitString::kWordBits)
+    {
+    }
+
+    size_t size() const
+    {
+        return labels_.size();
+    }
+
+    size_t inputs() const
+    {
+        return inputs_;
+    }
+
+    void reserve(const size_t rows)
+    {
+        words_.reserve(rows * stride_);
+        labels_.reserve(rows);
+    }
+
+    /* Appends a pattern read from the inputs() values starting at first; any non-zero value is a set bit. */
+    template <typename Iterator>
+    void push(Iterator first, const float label)
+    {
+        words_.resize(words_.size() + stride_, 0);
+        uint64_t* row = &words_[words_.size() - stride_];
+        for (size_t i = 0; i < inputs_; ++i, ++first)
+        {
+            if (*first)
+            {
+                row[i / BitString::kWordBits] |= static_cast<uint64_t>(1) << (i % BitString::kWordBits);
+            }
+        }
+        labels_.push_back(label);
+    }
+
+    const uint64_t* row(const size_t i) const
+    {
+        assert(i < size());
+
+        return words_.data() + i * stride_;
+    }
+
+    float label(const size_t i) const
+    {
+        return labels_[i];
+    }
+
+    template <typename Weight>
+    float activate(const Weight* weights, const size_t i) const
+    {
+        const uint64_t* words = row(i);
+        float sum = weights[inputs_];
+        for (size_t w = 0; w < stride_; ++w)
+        {
+            for (uint64_t word = words[w]; word; word &= word - 1)
+            {
+                sum += weights[w * BitString::kWordBits + BitString::lowestBit(word)];
+            }
+        }
+        return sum;
+    }
+
+    template <typename Weight>
+    void update(Weight* weights, const size_t i, const float scale) const
+    {
+        const uint64_t* words = row(i);
+        for (size_t w = 0; w < stride_; ++w)
+        {
+            for (uint64_t word = words[w]; word; word &= word - 1)
+            {
+                weights[w * BitString::kWordBits + BitString::lowestBit(word)] += scale;
+            }
+        }
+        weights[inputs_] += scale;
+    }
+
+private:
+
+    size_t inputs_;
+    size_t stride_;
+    std::vector<uint64_t> words_;
+    std::vector<float> labels_;
+};
+
+
+/*
+ * Patterns in compressed sparse rows: the non-zero inputs of row i are indices[offsets[i]..offsets[i + 1]) with their
+ * values at the same positions. Activation and updates cost the row's non-zeros, whatever inputs() is.
+ */
+class SparseDataset
+{
+public:
+
+    explicit SparseDataset(const size_t inputs)
+        : inputs_(inputs)
+        , offsets_(1, 0)
+    {
+    }
+
+    SparseDataset(const size_t inputs,
+                  std::vector<size_t> offsets,
+                  std::vector<uint32_t> indices,
+                  std::vector<float> values,
+                  std::vector<float> labels)
+        : inputs_(inputs)
+        , offsets_(std::move(offsets))
+        , indices_(std::move(indices))
+        , values_(std::move(values))
+        , labels_(std::move(labels))
+    {
+        assert(offsets_.size() == labels_.size() + 1 && !offsets_.front());
+        assert(offsets_.back() == indices_.size() && indices_.size() == values_.size());
+    }
+
+    size_t size() const
+    {
+        return labels_.size();
+    }
+
+    size_t inputs() const
+    {
+        return inputs_;
+    }
+
+    /* Appends a pattern whose non-zero inputs are [firstIndex, lastIndex) with values from firstValue on. */
+    template <typename IndexIterator, typename ValueIterator>
+    void push(IndexIterator firstIndex, IndexIterator lastIndex, ValueIterator firstValue, const float label)
+    {
+        for (; firstIndex != lastIndex; ++firstIndex, ++firstValue)
+        {
+            assert(static_cast<size_t>(*firstIndex) < inputs_);
+
+            indices_.push_back(static_cast<uint32_t>(*firstIndex));
+            values_.push_back(static_cast<float>(*firstValue));
+        }
+        offsets_.push_back(indices_.size());
+        labels_.push_back(label);
+    }
+
+    float label(const size_t i) const
+    {
+        return labels_[i];
+    }
+
+    template <typename Weight>
+    float activate(const Weight* weights, const size_t i) const
+    {
+        float sum = weights[inputs_];
+        for (size_t j = offsets_[i]; j < offsets_[i + 1]; ++j)
+        {
+            sum += weights[indices_[j]] * values_[j];
+        }
+        return sum;
+    }
+
+    template <typename Weight>
+    void update(Weight* weights, const size_t i, const float scale) const
+    {
+        for (size_t j = offsets_[i]; j < offsets_[i + 1]; ++j)
+        {
+            weights[indices_[j]] += scale * values_[j];
+        }
+        weights[inputs_] += scale;
+    }
+
+private:
+
+    size_t inputs_;
+    std::vector<size_t> offsets_;
+    std::vector<uint32_t> indices_;
+    std::vector<float> values_;
+    std::vector<float> labels_;
+};
+
+} /* namespace CleverAlgorithms */
+
+#endif /* DATASET_H_C4C65A8C_C9F3_11F1_B2F4_C038963D1C06 */
@@ -4,6 +4,8 @@
  */
 
 
+#include <ctime>
+
 #include "Perceptron.h"
 
 
@@ -18,8 +20,14 @@ int main()
     const size_t kInputs = 2;
     const size_t kIterations = 20;
     const float kLearningRate = 0.1f;
+    const uint64_t kSeed = static_cast<uint64_t>(time(nullptr));
 
-    (void)CleverAlgorithms::Perceptron::execute(orProblem, kInputs, kIterations, kLearningRate);
+    CleverAlgorithms::BinaryDataset dataset(kInputs);
+    for (const auto& pattern: orProblem)
+    {
+        dataset.push(pattern.first.begin(), static_cast<float>(pattern.second));
+    }
+    (void)CleverAlgorithms::Perceptron::execute(dataset, kIterations, kLearningRate, kSeed);
     return 0;
 }
 
@@ -0,0 +1,111 @@
+/*
+ * Filename: MappedDataset.cpp
+ * Author:   Michael Tkach (x1mike7x@gmail.com)
+ */
+
+
+#include <cstring>
+#include <stdexcept>
+
+#include "MappedDataset.h"
+
+
+namespace CleverAlgorithms
+{
+
+namespace
+{
+
+const char kDatasetSignature[4] = {'P', 'D', 'N', 'S'};
+
+} /* anonymous namespace */
+
+
+MappedDenseDataset::MappedDenseDataset(const std::string& filename)
+    : file_(filename)
+    , inputs_(0)
+    , stride_(0)
+    , rows_(0)
+    , values_(nullptr)
+{
+    DatasetHeader header;
+    if (file_.size() < sizeof(header))
+    {
+        throw std::runtime_error("Truncated dataset: " + filename);
+    }
+    std::memcpy(&header, file_.begin(), sizeof(header));
+    if (std::memcmp(header.signature, kDatasetSignature, sizeof(kDatasetSignature)))
+    {
+        throw std::runtime_error("Not a dataset: " + filename);
+    }
+    if (header.stride <= header.inputs || header.stride % kSimdLanes)
+    {
+        throw std::runtime_error("Corrupt dataset header in " + filename);
+    }
+    /* Compared in floats: stride * sizeof(float) could overflow for a corrupt header. stride > inputs, so it is not zero. */
+    const uint64_t payload = (file_.size() - sizeof(header)) / sizeof(float);
+    if (header.rows && (header.stride > payload || payload / header.stride < header.rows))
+    {
+        throw std::runtime_error("Truncated dataset: " + filename);
+    }
+
+    inputs_ = static_cast<size_t>(header.inputs);
+    stride_ = static_cast<size_t>(header.stride);
+    rows_ = static_cast<size_t>(header.rows);
+    values_ = reinterpret_cast<const float*>(file_.begin() + sizeof(header));
+}
+
+
+DenseDatasetWriter::DenseDatasetWriter(const std::string& filename, const size_t inputs)
+    : filename_(filename)
+    , out_(std::fopen(filename.c_str(), "wb"))
+    , record_((inputs + kSimdLanes) / kSimdLanes * kSimdLanes, 0.0f)
+{
+    if (!out_)
+    {
+        throw std::runtime_error("Cannot create file: " + filename);
+    }
+    std::memset(&header_, 0, sizeof(header_));
+    std::memcpy(header_.signature, kDatasetSignature, sizeof(kDatasetSignature));
+    header_.inputs = inputs;
+    header_.stride = record_.size();
+    write(&header_, sizeof(header_));
+}
+
+
+DenseDatasetWriter::~DenseDatasetWriter()
+{
+    if (out_)
+    {
+        std::fclose(out_);
+    }
+}
+
+
+void DenseDatasetWriter::close()
+{
+    assert(out_);
+
+    if (std::fseek(out_, 0, SEEK_SET) != 0)
+    {
+        throw std::runtime_error("Cannot write file: " + filename_);
+    }
+    write(&header_, sizeof(header_));
+    const bool closed = std::fclose(out_) == 0;
+    out_ = nullptr;
+    if (!closed)
+    {
+        throw std::runtime_error("Cannot write file: " + filename_);
+    }
+}
+
+
+void DenseDatasetWriter::write(const void* data, const size_t size)
+{
+    if (std::fwrite(data, 1, size, out_) != size)
+    {
+        throw std::runtime_error("Cannot write file: " + filename_);
+    }
+}
+
+} /* namespace CleverAlgorithms */
@@ -0,0 +1,134 @@
+/*
+ * Filename: MappedDataset.h
+ * Author:   Michael Tkach (x1mike7x@gmail.com)
+ */
+
+
+#ifndef MAPPEDDATASET_H_C4C65B6F_C9F3_11F1_8D5A_C038963D1C06
+#define MAPPEDDATASET_H_C4C65B6F_C9F3_11F1_8D5A_C038963D1C06
+
+
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+#include "Dataset.h"
+#include "../Common/MappedFile.h"
+
+
+namespace CleverAlgorithms
+{
+
+/*
+ * Dense patterns in a binary file: a one cache line header, then a record of stride floats per pattern holding the
+ * inputs, the label and zero padding. Records are cache-line aligned in the file and therefore in the mapping.
+ */
+struct DatasetHeader
+{
+    char signature[4];
+    uint32_t reserved;
+    uint64_t inputs;
+    uint64_t stride;
+    uint64_t rows;
+    char padding[kSimdLanes * sizeof(float) - 32];
+};
+
+static_assert(sizeof(DatasetHeader) == kSimdLanes * sizeof(float), "The records must start on a cache line");
+
+
+/*
+ * Dense dataset streamed from a file written by DenseDatasetWriter. The file is memory mapped: each epoch pages the
+ * records in sequentially and the kernel may drop them again, so the dataset never has to fit in memory.
+ */
+class MappedDenseDataset
+{
+public:
+
+    explicit MappedDenseDataset(const std::string& filename);
+
+    size_t size() const
+    {
+        return rows_;
+    }
+
+    size_t inputs() const
+    {
+        return inputs_;
+    }
+
+    const float* row(const size_t i) const
+    {
+        assert(i < size());
+
+        return values_ + i * stride_;
+    }
+
+    float label(const size_t i) const
+    {
+        return row(i)[inputs_];
+    }
+
+    float activate(const float* weights, const size_t i) const
+    {
+        return dotProduct(weights, row(i), inputs_) + weights[inputs_];
+    }
+
+    void update(float* weights, const size_t i, const float scale) const
+    {
+        addScaled(weights, scale, row(i), inputs_);
+        weights[inputs_] += scale;
+    }
+
+private:
+
+    MappedFile file_;
+    size_t inputs_;
+    size_t stride_;
+    size_t rows_;
+    const float* values_;
+};
+
+
+/* Appends patterns to a dataset file one at a time; close() completes the header. */
+class DenseDatasetWriter
+{
+public:
+
+    DenseDatasetWriter(const std::string& filename, const size_t inputs);
+    ~DenseDatasetWriter();
+
+    DenseDatasetWriter(const DenseDatasetWriter&) = delete;
+    DenseDatasetWriter& operator=(const DenseDatasetWriter&) = delete;
+
+    /* Appends a pattern read from the inputs values starting at first. */
+    template <typename Iterator>
+    void push(Iterator first, const float label)
+    {
+        for (size_t i = 0; i < header_.inputs; ++i, ++first)
+        {
+            record_[i] = static_cast<float>(*first);
+        }
+        record_[header_.inputs] = label;
+        write(record_.data(), record_.size() * sizeof(float));
+        ++header_.rows;
+    }
+
+    void close();
+
+private:
+
+    void write(const void* data, const size_t size);
+
+
+    std::string filename_;
+    FILE* out_;
+    DatasetHeader header_;
+    std::vector<float> record_;
+};
+
+} /* namespace CleverAlgorithms */
+
+#endif /* MAPPEDDATASET_H_C4C65B6F_C9F3_11F1_8D5A_C038963D1C06 */
@@ -6,10 +6,14 @@
 
 #include <algorithm>
 #include <cassert>
-#include <ctime>
+#include <cmath>
+#include <functional>
 #include <iostream>
+#include <thread>
 
 #include "Perceptron.h"
+#include "../Common/Barrier.h"
+#include "../Common/Random.h"
 
 
 namespace CleverAlgorithms
@@ -18,107 +22,267 @@ namespace CleverAlgorithms
 namespace
 {
 
-inline float random(const float left, const float right)
-{
-    assert(left <= right);
-    return left + (right - left) * (static_cast<float>(rand()) / RAND_MAX);
-}
-
-
-inline std::vector<float> randomVector(const std::vector<std::pair<float, float>>& bounds)
+inline std::vector<float> randomVector(const std::vector<std::pair<float, float>>& bounds, Random& random)
 {
     std::vector<float> res(bounds.size());
     for (size_t i = 0; i < bounds.size(); ++i)
     {
-        res[i] = random(bounds[i].first, bounds[i].second);
+        res[i] = random.uniformFloat(bounds[i].first, bounds[i].second);
     }
     return res;
 }
 
 
-inline std::vector<float> initializeWeights(const size_t problemSize)
+inline std::vector<float> initializeWeights(const size_t problemSize, Random& random)
 {
     std::vector<std::pair<float, float>> bounds(problemSize + 1, {-1.0f, 1.0f});
-    return randomVector(bounds);
+    return randomVector(bounds, random);
+}
+
+
+float transfer(float activation)
+{
+    return (activation >= 0.0f) ? 1.0f : 0.0f;
 }
 
 
-void updateWeights(const size_t numInputs,
-                   std::vector<float>& weights,
-                   const std::vector<size_t>& input,
-                   const float outExpected,
-                   const float outActual,
-                   const float learningRate)
+template <typename Dataset>
+float getOutput(const std::vector<float>& weights, const Dataset& domain, const size_t pattern)
 {
-    assert(numInputs == input.size());
-    assert(weights.size() == input.size() + 1);
+    float activation = domain.activate(weights.data(), pattern);
+    return transfer(activation);
+}
+
+
+/*
+ * Multiply-adds a thread must get to pay for its start-up: about 120 us of scoring against about 20 us to create
+ * and join a thread, so a 10k-row batch of 32 inputs stays on the calling thread.
+ */
+const size_t kMinWorkPerThread = 1 << 18;
 
-    for (size_t i = 0; i < numInputs; ++i)
+
+/* Activations of rows [first, last), or the outputs when applyTransfer is set, so that the transfer runs in the same pass. */
+inline void scoreRows(const std::vector<float>& weights,
+                      const float* inputs,
+                      const size_t first,
+                      const size_t last,
+                      const size_t stride,
+                      float* results,
+                      const bool applyTransfer)
+{
+    const size_t inputsCount = weights.size() - 1;
+    for (size_t i = first; i < last; ++i)
     {
-        weights[i] += learningRate * (outExpected - outActual) * input[i];
+        const float activation = dotProduct(weights.data(), inputs + i * stride, inputsCount) + weights.back();
+        results[i] = applyTransfer ? transfer(activation) : activation;
     }
-    weights.back() += learningRate * (outExpected - outActual) * 1.0f;
 }
 
 
-float activate(const std::vector<float>& weights, const std::vector<size_t>& vector)
+/* Splits the rows into blocks of at least kMinWorkPerThread multiply-adds; a single block runs on the calling thread only. */
+inline void scoreBlocks(const std::vector<float>& weights,
+                        const float* inputs,
+                        const size_t rows,
+                        const size_t stride,
+                        float* results,
+                        const unsigned threadsCount,
+                        const bool applyTransfer)
 {
-    assert(weights.size() == vector.size() + 1);
+    assert(!weights.empty() && stride >= weights.size() - 1);
 
-    float sum = weights.back() * 1.0f;
-    for (size_t i = 0; i < vector.size(); ++i)
+    const size_t work = rows * std::max<size_t>(1, weights.size() - 1);
+    const size_t blocks = std::max<size_t>(1, std::min<size_t>(threadsCount, work / kMinWorkPerThread));
+    if (blocks == 1)
+    {
+        scoreRows(weights, inputs, 0, rows, stride, results, applyTransfer);
+        return;
+    }
+    std::vector<std::thread> workers;
+    workers.reserve(blocks - 1);
+    for (size_t b = 1; b < blocks; ++b)
     {
-        sum += weights[i] * vector[i];
+        workers.emplace_back(scoreRows, std::cref(weights), inputs, rows * b / blocks, rows * (b + 1) / blocks, stride, results,
+                             applyTransfer);
+    }
+    scoreRows(weights, inputs, 0, rows / blocks, stride, results, applyTransfer);
+    for (size_t i = 0; i < workers.size(); ++i)
+    {
+        workers[i].join();
     }
-    return sum;
 }
 
 
-float transfer(float activation)
+template <typename Dataset>
+void trainWeights(std::vector<float>& weights,
+                  const Dataset& domain,
+                  const size_t iterations,
+                  const float learningRate)
 {
-    return (activation >= 0.0f) ? 1.0f : 0.0f;
+    assert(weights.size() == domain.inputs() + 1);
+
+    for (size_t epoch = 0; epoch < iterations; ++epoch)
+    {
+        float error = 0.0f;
+        for (size_t i = 0; i < domain.size(); ++i)
+        {
+            float expected = domain.label(i);
+            float output = getOutput(weights, domain, i);
+            error += std::abs(output - expected);
+            domain.update(weights.data(), i, learningRate * (expected - output));
+        }
+        std::clog << "Train epoch #" << epoch << ": error = " << error << "\n";
+    }
 }
 
 
-float getOutput(const std::vector<float>& weights, const std::vector<size_t>& vector)
+/* Runs every epoch over the patterns [first, last) against weights shared with the other shards. */
+template <typename Dataset>
+void trainShard(std::vector<RelaxedFloat>& weights,
+                const Dataset& domain,
+                const size_t first,
+                const size_t last,
+                const size_t iterations,
+                const float learningRate,
+                std::vector<float>& errors)
 {
-    float activation = activate(weights, vector);
-    return transfer(activation);
+    for (size_t epoch = 0; epoch < iterations; ++epoch)
+    {
+        float error = 0.0f;
+        for (size_t i = first; i < last; ++i)
+        {
+            float expected = domain.label(i);
+            float output = transfer(domain.activate(weights.data(), i));
+            error += std::abs(output - expected);
+            domain.update(weights.data(), i, learningRate * (expected - output));
+        }
+        errors[epoch] = error;
+    }
 }
 
 
-void trainWeights(std::vector<float>& weights,
-                  const std::vector<std::pair<std::vector<size_t>, size_t>>& domain,
-                  const size_t numInputs,
-                  const size_t iterations,
-                  const float learningRate)
+/* Hogwild: every thread trains on its own shard of the patterns and updates the shared weights without locking. */
+template <typename Dataset>
+void trainWeightsHogwild(std::vector<float>& weights,
+                         const Dataset& domain,
+                         const size_t iterations,
+                         const float learningRate,
+                         const unsigned threadsCount)
 {
+    assert(weights.size() == domain.inputs() + 1);
+
+    std::vector<RelaxedFloat> shared(weights.size());
+    for (size_t i = 0; i < weights.size(); ++i)
+    {
+        shared[i] = weights[i];
+    }
+    std::vector<std::vector<float>> errors(threadsCount, std::vector<float>(iterations, 0.0f));
+    std::vector<std::thread> workers;
+    workers.reserve(threadsCount - 1);
+    for (unsigned t = 1; t < threadsCount; ++t)
+    {
+        workers.emplace_back(trainShard<Dataset>, std::ref(shared), std::cref(domain), domain.size() * t / threadsCount,
+                             domain.size() * (t + 1) / threadsCount, iterations, learningRate, std::ref(errors[t]));
+    }
+    trainShard(shared, domain, 0, domain.size() / threadsCount, iterations, learningRate, errors[0]);
+    for (size_t i = 0; i < workers.size(); ++i)
+    {
+        workers[i].join();
+    }
+
+    for (size_t i = 0; i < weights.size(); ++i)
+    {
+        weights[i] = shared[i];
+    }
     for (size_t epoch = 0; epoch < iterations; ++epoch)
     {
         float error = 0.0f;
-        for (const auto& pattern: domain)
+        for (unsigned t = 0; t < threadsCount; ++t)
         {
-            const std::vector<size_t>& input = pattern.first;
-            float expected = static_cast<float>(pattern.second);
-            float output = getOutput(weights, input);
-            error += std::abs(output - expected);
-            updateWeights(numInputs, weights, input, expected, output, learningRate);
+            error += errors[t][epoch];
         }
         std::clog << "Train epoch #" << epoch << ": error = " << error << "\n";
     }
 }
 
 
-size_t testWeights(const std::vector<float>& weights,
-                   const std::vector<std::pair<std::vector<size_t>, size_t>>& domain,
-                   const size_t numInputs)
+/*
+ * Synchronous mini-batches: the threads split each batch, accumulate their updates against the same weights into
+ * their own buffers, and the last thread at the barrier adds all buffers to the weights.
+ */
+template <typename Dataset>
+void trainWeightsMiniBatch(std::vector<float>& weights,
+                           const Dataset& domain,
+                           const size_t iterations,
+                           const float learningRate,
+                           const size_t batchSize,
+                           const unsigned threadsCount)
+{
+    assert(weights.size() == domain.inputs() + 1);
+    assert(batchSize);
+
+    std::vector<std::vector<float>> gradients(threadsCount, std::vector<float>(weights.size(), 0.0f));
+    std::vector<float> errors(threadsCount, 0.0f);
+    Barrier barrier(threadsCount);
+
+    auto worker = [&](const unsigned t)
+    {
+        std::vector<float>& gradient = gradients[t];
+        for (size_t epoch = 0; epoch < iterations; ++epoch)
+        {
+            for (size_t batch = 0; batch < domain.size(); batch += batchSize)
+            {
+                const size_t length = std::min(batchSize, domain.size() - batch);
+                for (size_t i = batch + length * t / threadsCount; i < batch + length * (t + 1) / threadsCount; ++i)
+                {
+                    float expected = domain.label(i);
+                    float output = getOutput(weights, domain, i);
+                    errors[t] += std::abs(output - expected);
+                    domain.update(gradient.data(), i, learningRate * (expected - output));
+                }
+                barrier.wait([&]
+                {
+                    for (unsigned j = 0; j < threadsCount; ++j)
+                    {
+                        addScaled(weights.data(), 1.0f, gradients[j].data(), weights.size());
+                        std::fill(gradients[j].begin(), gradients[j].end(), 0.0f);
+                    }
+                    if (batch + length == domain.size())
+                    {
+                        float error = 0.0f;
+                        for (unsigned j = 0; j < threadsCount; ++j)
+                        {
+                            error += errors[j];
+                            errors[j] = 0.0f;
+                        }
+                        std::clog << "Train epoch #" << epoch << ": error = " << error << "\n";
+                    }
+                });
+            }
+        }
+    };
+
+    std::vector<std::thread> workers;
+    workers.reserve(threadsCount - 1);
+    for (unsigned t = 1; t < threadsCount; ++t)
+    {
+        workers.emplace_back(worker, t);
+    }
+    worker(0);
+    for (size_t i = 0; i < workers.size(); ++i)
+    {
+        workers[i].join();
+    }
+}
+
+
+template <typename Dataset>
+size_t testWeights(const std::vector<float>& weights, const Dataset& domain)
 {
     size_t correct = 0;
-    for (const auto& pattern: domain)
+    for (size_t i = 0; i < domain.size(); ++i)
     {
-        const std::vector<size_t>& input = pattern.first;
-        float output = getOutput(weights, input);
-        correct += (static_cast<size_t>(output + std::numeric_limits<float>::epsilon()) == pattern.second) ? 1 : 0;
+        float output = getOutput(weights, domain, i);
+        correct += (output == domain.label(i)) ? 1 : 0;
     }
     std::clog << "Test result: " << 100.f * correct / domain.size() << "%\n";
     return correct;
@@ -130,13 +294,126 @@ size_t testWeights(const std::vector<float>& weights,
 std::vector<float> Perceptron::execute(const std::vector<std::pair<std::vector<size_t>, size_t>>& domain,
                                        const size_t inputs,
                                        const size_t iterations,
-                                       const float learningRate)
+                                       const float learningRate,
+                                       const uint64_t seed)
+{
+    DenseDataset dataset(inputs);
+    dataset.reserve(domain.size());
+    for (const auto& pattern: domain)
+    {
+        assert(pattern.first.size() == inputs);
+
+        dataset.push(pattern.first.begin(), static_cast<float>(pattern.second));
+    }
+    return execute(dataset, iterations, learningRate, seed);
+}
+
+
+std::vector<float> Perceptron::execute(const DenseDataset& domain,
+                                       const size_t iterations,
+                                       const float learningRate,
+                                       const uint64_t seed)
+{
+    Random random(seed);
+
+    std::vector<float> weights = initializeWeights(domain.inputs(), random);
+    trainWeights(weights, domain, iterations, learningRate);
+    (void)testWeights(weights, domain);
+    return weights;
+}
+
+
+std::vector<float> Perceptron::execute(const BinaryDataset& domain,
+                                       const size_t iterations,
+                                       const float learningRate,
+                                       const uint64_t seed)
+{
+    Random random(seed);
+
+    std::vector<float> weights = initializeWeights(domain.inputs(), random);
+    trainWeights(weights, domain, iterations, learningRate);
+    (void)testWeights(weights, domain);
+    return weights;
+}
+
+
+std::vector<float> Perceptron::execute(const SparseDataset& domain,
+                                       const size_t iterations,
+                                       const float learningRate,
+                                       const uint64_t seed)
+{
+    Random random(seed);
+
+    std::vector<float> weights = initializeWeights(domain.inputs(), random);
+    trainWeights(weights, domain, iterations, learningRate);
+    (void)testWeights(weights, domain);
+    return weights;
+}
+
+
+std::vector<float> Perceptron::execute(const MappedDenseDataset& domain,
+                                       const size_t iterations,
+                                       const float learningRate,
+                                       const uint64_t seed)
+{
+    Random random(seed);
+
+    std::vector<float> weights = initializeWeights(domain.inputs(), random);
+    trainWeights(weights, domain, iterations, learningRate);
+    (void)testWeights(weights, domain);
+    return weights;
+}
+
+
+void Perceptron::score(const std::vector<float>& weights,
+                       const float* inputs,
+                       const size_t rows,
+                       const size_t stride,
+                       float* activations,
+                       const unsigned threadsCount)
+{
+    scoreBlocks(weights, inputs, rows, stride, activations, threadsCount, false);
+}
+
+
+void Perceptron::predict(const std::vector<float>& weights,
+                         const float* inputs,
+                         const size_t rows,
+                         const size_t stride,
+                         float* outputs,
+                         const unsigned threadsCount)
+{
+    scoreBlocks(weights, inputs, rows, stride, outputs, threadsCount, true);
+}
+
+
+std::vector<float> Perceptron::executeHogwild(const SparseDataset& domain,
+                                              const size_t iterations,
+                                              const float learningRate,
+                                              const unsigned threadsCount,
+                                              const uint64_t seed)
+{
+    Random random(seed);
+
+    std::vector<float> weights = initializeWeights(domain.inputs(), random);
+    trainWeightsHogwild(weights, domain, iterations, learningRate, std::max(1u, threadsCount));
+    (void)testWeights(weights, domain);
+    return weights;
+}
+
+
+std::vector<float> Perceptron::executeMiniBatch(const DenseDataset& domain,
+                                                const size_t iterations,
+                                                const float learningRate,
+                                                const size_t batchSize,
+                                                const unsigned threadsCount,
+                                                const uint64_t seed)
 {
-    srand(static_cast<unsigned>(time(nullptr)));
+    Random random(seed);
 
-    std::vector<float> weights = initializeWeights(inputs);
-    trainWeights(weights, domain, inputs, iterations, learningRate);
-    (void)testWeights(weights, domain, inputs);
+    std::vector<float> weights = initializeWeights(domain.inputs(), random);
+    trainWeightsMiniBatch(weights, domain, iterations, learningRate, batchSize, std::max(1u, threadsCount));
+    (void)testWeights(weights, domain);
     return weights;
 }
 
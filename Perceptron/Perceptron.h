@@ -8,9 +8,14 @@
 #define PERCEPTRON_H_E63FD730_37EC_11E6_8CBB_C038963D1C06
 
 
+#include <cstdint>
 #include <cstdlib>
+#include <utility>
 #include <vector>
 
+#include "Dataset.h"
+#include "MappedDataset.h"
+
 
 namespace CleverAlgorithms
 {
@@ -22,7 +27,64 @@ public:
     static std::vector<float> execute(const std::vector<std::pair<std::vector<size_t>, size_t>>& domain,
                                       const size_t inputs,
                                       const size_t iterations,
-                                      const float learningRate);
+                                      const float learningRate,
+                                      const uint64_t seed);
+
+    static std::vector<float> execute(const DenseDataset& domain,
+                                      const size_t iterations,
+                                      const float learningRate,
+                                      const uint64_t seed);
+
+    static std::vector<float> execute(const BinaryDataset& domain,
+                                      const size_t iterations,
+                                      const float learningRate,
+                                      const uint64_t seed);
+
+    static std::vector<float> execute(const SparseDataset& domain,
+                                      const size_t iterations,
+                                      const float learningRate,
+                                      const uint64_t seed);
+
+    /* Streams the patterns from a memory-mapped file epoch by epoch. */
+    static std::vector<float> execute(const MappedDenseDataset& domain,
+                                      const size_t iterations,
+                                      const float learningRate,
+                                      const uint64_t seed);
+
+    /* Lock-free training from threadsCount threads, each over its own shard of the patterns. */
+    static std::vector<float> executeHogwild(const SparseDataset& domain,
+                                             const size_t iterations,
+                                             const float learningRate,
+                                             const unsigned threadsCount,
+                                             const uint64_t seed);
+
+    /* Synchronous training: each batch of batchSize patterns is split across threadsCount threads and its updates summed. */
+    static std::vector<float> executeMiniBatch(const DenseDataset& domain,
+                                               const size_t iterations,
+                                               const float learningRate,
+                                               const size_t batchSize,
+                                               const unsigned threadsCount,
+                                               const uint64_t seed);
+
+    /*
+     * Writes the activations of rows patterns to activations. Pattern i holds weights.size() - 1 floats from
+     * inputs + i * stride on, e.g. DenseDataset::row(0) with DenseDataset::stride(). Large blocks are split across
+     * up to threadsCount threads; nothing is allocated for the results.
+     */
+    static void score(const std::vector<float>& weights,
+                      const float* inputs,
+                      const size_t rows,
+                      const size_t stride,
+                      float* activations,
+                      const unsigned threadsCount);
+
+    /* As score(), but writes the perceptron outputs, 0 or 1. */
+    static void predict(const std::vector<float>& weights,
+                        const float* inputs,
+                        const size_t rows,
+                        const size_t stride,
+                        float* outputs,
+                        const unsigned threadsCount);
 };
 
 } /* namespace CleverAlgorithms */
@@ -7,6 +7,8 @@
 #include <iostream>
 #include <vector>
 #include <utility>
+#include <ctime>
+#include <thread>
 
 #include "RandomSearch.h"
 
@@ -33,7 +35,9 @@ int main()
     const int kProblemSize = 2;
     std::vector<std::pair<float, float>> searchSpace(kProblemSize, std::make_pair(-5.0f, 5.0f));
     const int kMaxIter = 1000;
+    const unsigned kThreadsCount = std::thread::hardware_concurrency();
+    const uint64_t kSeed = static_cast<uint64_t>(time(nullptr));
 
-    CleverAlgorithms::RandomSearch::Candidate best = CleverAlgorithms::RandomSearch::search(searchSpace, kMaxIter);
+    CleverAlgorithms::RandomSearch::Candidate best = CleverAlgorithms::RandomSearch::searchParallel(searchSpace, kMaxIter, kThreadsCount, kSeed);
     printResult(best);
 }
@@ -4,12 +4,19 @@
  */
 
 
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+#include <cstddef>
+#include <functional>
+#include <limits>
+#include <thread>
 #include <vector>
 #include <utility>
-#include <cstdlib>
-#include <ctime>
 
 #include "RandomSearch.h"
+#include "../Common/Objectives.h"
+#include "../Common/Random.h"
 
 
 namespace CleverAlgorithms
@@ -18,46 +25,142 @@ namespace CleverAlgorithms
 namespace
 {
 
-inline float objectiveFunction(const std::vector<float>& values)
+/* Candidates per batch: a multiple of every SIMD width, so the lane loops below vectorize without remainders. */
+const size_t kBatchSize = 64;
+
+
+/* Adds the squares of one coordinate of every candidate in the batch to their costs. */
+inline void accumulateSquares(const float* values, float* costs)
 {
-    float res = 0.0f;
-    for (size_t i = 0; i < values.size(); ++i)
+    for (size_t i = 0; i < kBatchSize; ++i)
     {
-        res += values[i] * values[i];
+        costs[i] += values[i] * values[i];
     }
-    return res;
 }
 
 
-inline std::vector<float> randomVector(const std::vector<std::pair<float, float>>& searchSpace)
+/* Lowers bestCost to cost unless another thread has already gone below it. */
+inline void updateBestCost(std::atomic<float>& bestCost, const float cost)
 {
-    std::vector<float> res;
-    for (size_t i = 0; i < searchSpace.size(); ++i)
+    float current = bestCost.load(std::memory_order_relaxed);
+    while (cost < current && !bestCost.compare_exchange_weak(current, cost, std::memory_order_relaxed))
     {
-        float left = searchSpace[i].first;
-        float right = searchSpace[i].second;
-        float v = left + (right - left) * ((float)rand() / RAND_MAX);
-        res.push_back(v);
     }
-    return res;
+}
+
+
+/*
+ * Draws kSamplesCount candidates batch by batch and keeps the best of them in result. Stops early once bestCost,
+ * shared by all threads, has reached kTargetCost.
+ */
+inline void sampleBatches(const std::vector<std::pair<float, float>>& searchSpace,
+                          const int kSamplesCount,
+                          const float kTargetCost,
+                          Random random,
+                          std::atomic<float>& bestCost,
+                          RandomSearch::Candidate& result)
+{
+    const size_t dimensions = searchSpace.size();
+
+    /* Structure of arrays: coordinate d of candidate i is batch[d * kBatchSize + i]. */
+    std::vector<float> batch(dimensions * kBatchSize);
+    float costs[kBatchSize];
+    result.values.clear();
+    for (int iter = 0; iter < kSamplesCount && bestCost.load(std::memory_order_relaxed) > kTargetCost; iter += static_cast<int>(kBatchSize))
+    {
+        std::fill(costs, costs + kBatchSize, 0.0f);
+        for (size_t d = 0; d < dimensions; ++d)
+        {
+            float* values = batch.data() + d * kBatchSize;
+            random.fill(values, values + kBatchSize, searchSpace[d].first, searchSpace[d].second);
+            accumulateSquares(values, costs);
+        }
+
+        const size_t count = std::min(kBatchSize, static_cast<size_t>(kSamplesCount - iter));
+        const size_t winner = std::min_element(costs, costs + count) - costs;
+        if (result.values.empty() || costs[winner] < result.cost)
+        {
+            result.cost = costs[winner];
+            result.values.resize(dimensions);
+            for (size_t d = 0; d < dimensions; ++d)
+            {
+                result.values[d] = batch[d * kBatchSize + winner];
+            }
+            updateBestCost(bestCost, result.cost);
+        }
+    }
 }
 
 } /* anonymous namespace */
 
 
-RandomSearch::Candidate RandomSearch::search(const std::vector<std::pair<float, float>>& searchSpace, const int kIterLimit)
+RandomSearch::Candidate RandomSearch::search(const std::vector<std::pair<float, float>>& searchSpace, const int kIterLimit, const uint64_t kSeed)
 {
-    srand((unsigned)time(0));
+    return search(searchSpace, kIterLimit, SphereFunction(), kSeed);
+}
+
+
+RandomSearch::Candidate RandomSearch::search(const std::vector<std::pair<float, float>>& searchSpace,
+                                             const int kIterLimit,
+                                             const Objective& objective,
+                                             const uint64_t kSeed)
+{
+    return search<const Objective&>(searchSpace, kIterLimit, objective, kSeed);
+}
+
+
+RandomSearch::Candidate RandomSearch::searchBatched(const std::vector<std::pair<float, float>>& searchSpace, const int kIterLimit, const uint64_t kSeed)
+{
+    std::atomic<float> bestCost(std::numeric_limits<float>::infinity());
+    RandomSearch::Candidate best;
+    sampleBatches(searchSpace, kIterLimit, -std::numeric_limits<float>::infinity(), Random(kSeed), bestCost, best);
+    return best;
+}
+
+
+RandomSearch::Candidate RandomSearch::searchParallel(const std::vector<std::pair<float, float>>& searchSpace,
+                                                     const int kIterLimit,
+                                                     const unsigned kThreadsCount,
+                                                     const uint64_t kSeed)
+{
+    return searchParallel(searchSpace, kIterLimit, kThreadsCount, -std::numeric_limits<float>::infinity(), kSeed);
+}
+
+
+RandomSearch::Candidate RandomSearch::searchParallel(const std::vector<std::pair<float, float>>& searchSpace,
+                                                     const int kIterLimit,
+                                                     const unsigned kThreadsCount,
+                                                     const float kTargetCost,
+                                                     const uint64_t kSeed)
+{
+    assert(kIterLimit > 0);
+
+    const unsigned threadsCount = std::max(1u, std::min(kThreadsCount, static_cast<unsigned>(kIterLimit)));
+    Random random(kSeed);
+
+    std::atomic<float> bestCost(std::numeric_limits<float>::infinity());
+    std::vector<RandomSearch::Candidate> results(threadsCount);
+    std::vector<std::thread> workers;
+    workers.reserve(threadsCount - 1);
+    const Random mainRandom = random.stream();
+    for (unsigned i = 1; i < threadsCount; ++i)
+    {
+        const int samplesCount = static_cast<int>(static_cast<int64_t>(kIterLimit) * (i + 1) / threadsCount - static_cast<int64_t>(kIterLimit) * i / threadsCount);
+        workers.emplace_back(sampleBatches, std::cref(searchSpace), samplesCount, kTargetCost, random.stream(), std::ref(bestCost), std::ref(results[i]));
+    }
+    sampleBatches(searchSpace, kIterLimit / static_cast<int>(threadsCount), kTargetCost, mainRandom, bestCost, results[0]);
+    for (size_t i = 0; i < workers.size(); ++i)
+    {
+        workers[i].join();
+    }
+
     RandomSearch::Candidate best;
-    for (int i = 0; i < kIterLimit; ++i)
+    for (size_t i = 0; i < results.size(); ++i)
     {
-        RandomSearch::Candidate candidate;
-        candidate.values = randomVector(searchSpace);
-        candidate.cost = objectiveFunction(candidate.values);
-        if (!i || candidate.cost < best.cost)
+        if (!results[i].values.empty() && (best.values.empty() || results[i].cost < best.cost))
         {
-            best.cost = candidate.cost;
-            best.values.swap(candidate.values);
+            best.values.swap(results[i].values);
+            best.cost = results[i].cost;
         }
     }
     return best;
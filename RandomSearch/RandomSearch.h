@@ -7,6 +7,17 @@
 #ifndef RANDOMSEARCH_H_39D1B58C_F8D3_11E4_9ED5_C038963D1C06
 #define RANDOMSEARCH_H_39D1B58C_F8D3_11E4_9ED5_C038963D1C06
 
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <utility>
+#include <vector>
+
+#include "../Common/Random.h"
+
+
 namespace CleverAlgorithms
 {
 
@@ -14,15 +25,120 @@ class RandomSearch
 {
 public:
 
-    struct Candidate
+    template <typename Values>
+    struct BasicCandidate
     {
-        std::vector<float> values;
+        Values values;
         float cost;
     };
 
-    static Candidate search(const std::vector<std::pair<float, float>>& searchSpace, const int kIterLimit);
+    typedef BasicCandidate<std::vector<float>> Candidate;
+
+    /* Candidate of a dimension known at compile time: sampling it allocates nothing. */
+    template <size_t N>
+    using FixedCandidate = BasicCandidate<std::array<float, N>>;
+
+    typedef std::function<float(const std::vector<float>&)> Objective;
+
+
+    /* Minimizes the sphere function. */
+    static Candidate search(const std::vector<std::pair<float, float>>& searchSpace, const int kIterLimit, const uint64_t kSeed);
+
+    /* Type-erased objective: for expensive objectives or ones chosen at run time. */
+    static Candidate search(const std::vector<std::pair<float, float>>& searchSpace,
+                            const int kIterLimit,
+                            const Objective& objective,
+                            const uint64_t kSeed);
+
+    /* Any callable taking const std::vector<float>& and returning float; it is inlined into the sampling loop. */
+    template <typename Function>
+    static Candidate search(const std::vector<std::pair<float, float>>& searchSpace,
+                            const int kIterLimit,
+                            Function objective,
+                            const uint64_t kSeed);
+
+    /* Fixed dimension N: objective takes const std::array<float, N>&. */
+    template <size_t N, typename Function>
+    static FixedCandidate<N> search(const std::array<std::pair<float, float>, N>& searchSpace,
+                                    const int kIterLimit,
+                                    Function objective,
+                                    const uint64_t kSeed);
+
+    /* Sphere function only: samples and evaluates candidates in batches laid out as structure of arrays; only the winner is copied out. */
+    static Candidate searchBatched(const std::vector<std::pair<float, float>>& searchSpace, const int kIterLimit, const uint64_t kSeed);
+
+    /* Splits the samples across kThreadsCount threads, each with its own random stream, and reduces their bests. */
+    static Candidate searchParallel(const std::vector<std::pair<float, float>>& searchSpace,
+                                    const int kIterLimit,
+                                    const unsigned kThreadsCount,
+                                    const uint64_t kSeed);
+
+    /* As above, but all threads stop as soon as any of them finds a candidate with cost not above kTargetCost. */
+    static Candidate searchParallel(const std::vector<std::pair<float, float>>& searchSpace,
+                                    const int kIterLimit,
+                                    const unsigned kThreadsCount,
+                                    const float kTargetCost,
+                                    const uint64_t kSeed);
+
+private:
+
+    static void resize(std::vector<float>& values, const size_t size)
+    {
+        values.resize(size);
+    }
+
+    template <size_t N>
+    static void resize(std::array<float, N>&, const size_t)
+    {
+    }
+
+    template <typename Values, typename Bounds, typename Function>
+    static BasicCandidate<Values> sample(const Bounds& searchSpace, const int kIterLimit, Function& objective, const uint64_t kSeed);
 };
 
+
+template <typename Function>
+RandomSearch::Candidate RandomSearch::search(const std::vector<std::pair<float, float>>& searchSpace,
+                                             const int kIterLimit,
+                                             Function objective,
+                                             const uint64_t kSeed)
+{
+    return sample<std::vector<float>>(searchSpace, kIterLimit, objective, kSeed);
+}
+
+
+template <size_t N, typename Function>
+RandomSearch::FixedCandidate<N> RandomSearch::search(const std::array<std::pair<float, float>, N>& searchSpace,
+                                                     const int kIterLimit,
+                                                     Function objective,
+                                                     const uint64_t kSeed)
+{
+    return sample<std::array<float, N>>(searchSpace, kIterLimit, objective, kSeed);
+}
+
+
+template <typename Values, typename Bounds, typename Function>
+RandomSearch::BasicCandidate<Values> RandomSearch::sample(const Bounds& searchSpace, const int kIterLimit, Function& objective, const uint64_t kSeed)
+{
+    Random random(kSeed);
+    BasicCandidate<Values> best, candidate;
+    resize(best.values, searchSpace.size());
+    resize(candidate.values, searchSpace.size());
+    for (int i = 0; i < kIterLimit; ++i)
+    {
+        for (size_t d = 0; d < searchSpace.size(); ++d)
+        {
+            candidate.values[d] = random.uniformFloat(searchSpace[d].first, searchSpace[d].second);
+        }
+        candidate.cost = objective(static_cast<const Values&>(candidate.values));
+        if (!i || candidate.cost < best.cost)
+        {
+            std::swap(best, candidate);
+        }
+    }
+    return best;
+}
+
 } /* namespace CleverAlgorithms */
 
 #endif /* RANDOMSEARCH_H_39D1B58C_F8D3_11E4_9ED5_C038963D1C06 */
@@ -5,6 +5,8 @@
 
 
 #include <cassert>
+#include <ctime>
+#include <exception>
 #include <iostream>
 #include <utility>
 
@@ -14,7 +16,7 @@
 namespace
 {
 
-inline void printResult(const std::vector<std::pair<float, float>>& cities,
+inline void printResult(const std::vector<std::pair<double, double>>& cities,
                         const CleverAlgorithms::SimulatedAnnealing::Candidate& result)
 {
     assert(cities.size() == result.permutation.size());
@@ -36,7 +38,7 @@ inline void printResult(const std::vector<std::pair<float, float>>& cities,
 } /* anonymous namespace */
 
 
-int main()
+int main(int argc, char* argv[])
 {
     std::vector<std::pair<float, float>> berlin52 = { std::make_pair(565.0f, 575.0f), std::make_pair(25.0f, 185.0f),
         std::make_pair(345.0f, 750.0f), std::make_pair(945.0f, 685.0f), std::make_pair(845.0f, 655.0f), std::make_pair(880.0f, 660.0f),
@@ -52,14 +54,29 @@ int main()
         std::make_pair(875.0f, 920.0f), std::make_pair(700.0f, 500.0f), std::make_pair(555.0f, 815.0f), std::make_pair(830.0f, 485.0f),
         std::make_pair(1170.0f, 65.0f), std::make_pair(830.0f, 610.0f), std::make_pair(605.0f, 625.0f), std::make_pair(595.0f, 360.0f),
         std::make_pair(1340.0f, 725.0f), std::make_pair(1740.0f, 245.0f) };
+    CleverAlgorithms::TspInstance instance(berlin52);
+    if (argc > 1)
+    {
+        try
+        {
+            instance = CleverAlgorithms::TspInstance::load(argv[1]);
+        }
+        catch (const std::exception& e)
+        {
+            std::cerr << e.what() << "\n";
+            return 1;
+        }
+    }
     const int kIterLimit = 20000;
     const float kMaxTemperature = 100000.0f;
     const float kTemperatureChange = 0.992f;
+    const uint64_t kSeed = static_cast<uint64_t>(time(nullptr));
 
-    CleverAlgorithms::SimulatedAnnealing::Candidate result = CleverAlgorithms::SimulatedAnnealing::search(berlin52,
+    CleverAlgorithms::SimulatedAnnealing::Candidate result = CleverAlgorithms::SimulatedAnnealing::search(instance,
                                                                                                           kIterLimit,
                                                                                                           kMaxTemperature,
-                                                                                                          kTemperatureChange);
-    printResult(berlin52, result);
+                                                                                                          kTemperatureChange,
+                                                                                                          kSeed);
+    printResult(instance.cities, result);
     return 0;
 }
@@ -6,10 +6,16 @@
 
 #include <algorithm>
 #include <cassert>
-#include <ctime>
-#include <set>
+#include <cmath>
+#include <numeric>
+#include <thread>
 
 #include "SimulatedAnnealing.h"
+#include "../Common/ArrayTour.h"
+#include "../Common/Barrier.h"
+#include "../Common/Distances.h"
+#include "../Common/Random.h"
+#include "../Common/TwoLevelListTour.h"
 
 
 namespace CleverAlgorithms
@@ -18,17 +24,10 @@ namespace CleverAlgorithms
 namespace
 {
 
-inline float euc2d(const std::pair<float, float>& a, const std::pair<float, float>& b)
+template <typename DistanceTable>
+inline float cost(const DistanceTable& distances, const std::vector<int>& permutation)
 {
-    float dx = a.first - b.first;
-    float dy = a.second - b.second;
-    return std::sqrt(dx * dx + dy * dy);
-}
-
-
-inline float cost(const std::vector<std::pair<float, float>>& cities, const std::vector<int>& permutation)
-{
-    assert(cities.size() == permutation.size());
+    assert(distances.size() == permutation.size());
 
     float distance = 0.0f;
     for (size_t i = 0; i < permutation.size(); ++i)
@@ -36,98 +35,479 @@ inline float cost(const std::vector<std::pair<float, float>>& cities, const std:
         int j = i + 1 == permutation.size() ? 0 : i + 1;
         int c1 = permutation[i],
             c2 = permutation[j];
-        distance += euc2d(cities[c1], cities[c2]);
+        distance += distances(c1, c2);
     }
     return distance;
 }
 
 
-inline std::vector<int> randomPermutation(const std::vector<std::pair<float, float>>& cities)
+template <typename DistanceTable>
+inline std::vector<int> randomPermutation(const DistanceTable& distances, Random& random)
 {
-    std::vector<int> res(cities.size());
+    std::vector<int> res(distances.size());
     std::iota(res.begin(), res.end(), 0);
     for (size_t i = 0; i < res.size(); ++i)
     {
-        size_t r = rand() % (res.size() - i) + i;
+        size_t r = random.uniformInt(static_cast<uint32_t>(res.size() - i)) + i;
         std::swap(res[i], res[r]);
     }
     return res;
 }
 
 
-inline void stochasticTwoOpt(std::vector<int>& permutation)
+/* Reversing the path first..last replaces the edges (prev(first), first) and (last, next(last)). */
+struct TwoOptMove
 {
-    assert(permutation.size() >= 4);
+    int first;
+    int last;
+    float delta;
+};
+
 
-    size_t c1 = rand() % permutation.size(),
-           c2 = rand() % permutation.size();
-    std::set<size_t> exclude;
-    exclude.insert(c1);
-    exclude.insert(c1 ? c1 - 1 : permutation.size() - 1);
-    exclude.insert(c1 + 1 < permutation.size() ? c1 + 1 : 0);
-    while (exclude.count(c2))
+template <typename Tour, typename DistanceTable>
+inline TwoOptMove stochasticTwoOpt(const DistanceTable& distances, const Tour& tour, Random& random)
+{
+    assert(tour.size() >= 4);
+
+    const uint32_t n = static_cast<uint32_t>(tour.size());
+    const int b = random.uniformInt(n);
+    const int a = tour.prev(b),
+              next = tour.next(b);
+    int d = random.uniformInt(n);
+    while (d == b || d == a || d == next)
     {
-        c2 = rand() % permutation.size();
+        d = random.uniformInt(n);
     }
-    if (c1 > c2)
+    const int c = tour.prev(d);
+
+    TwoOptMove move;
+    move.first = b;
+    move.last = c;
+    move.delta = distances(a, c) + distances(b, d)
+               - distances(a, b) - distances(c, d);
+    return move;
+}
+
+
+template <typename Tour>
+inline void applyTwoOpt(Tour& tour, const TwoOptMove& move)
+{
+    tour.reverse(move.first, move.last);
+}
+
+
+inline bool shouldAccept(const float delta, const float kTemperature, Random& random)
+{
+    if (delta < 0.0f)
     {
-        std::swap(c1, c2);
+        return true;
     }
-    std::reverse(permutation.begin() + c1, permutation.begin() + c2);
+    const float randomValue = random.uniformFloat();
+    return std::exp(-delta / kTemperature) > randomValue;
 }
 
 
-inline SimulatedAnnealing::Candidate createNeighbor(const SimulatedAnnealing::Candidate& current, const std::vector<std::pair<float, float>>& cities)
+template <typename Tour>
+struct Replica
 {
-    SimulatedAnnealing::Candidate candidate;
-    candidate.permutation = current.permutation;
-    stochasticTwoOpt(candidate.permutation);
-    candidate.cost = cost(cities, candidate.permutation);
-    return candidate;
+    Tour current;
+    float currentCost;
+    SimulatedAnnealing::Candidate best;
+    float temperature;
+    Random random;
+
+
+    explicit Replica(const Random& kRandom)
+        : currentCost(0.0f)
+        , temperature(0.0f)
+        , random(kRandom)
+    {
+        best.cost = 0.0f;
+    }
+};
+
+
+/* Metropolis steps at the replica's fixed temperature. */
+template <typename Tour, typename DistanceTable>
+inline void anneal(const DistanceTable& distances, Replica<Tour>& replica, const int kSteps)
+{
+    for (int step = 0; step < kSteps; ++step)
+    {
+        TwoOptMove move = stochasticTwoOpt(distances, replica.current, replica.random);
+        if (shouldAccept(move.delta, replica.temperature, replica.random))
+        {
+            applyTwoOpt(replica.current, move);
+            replica.currentCost += move.delta;
+            if (replica.currentCost < replica.best.cost)
+            {
+                replica.current.permutation(replica.best.permutation);
+                replica.best.cost = replica.currentCost;
+            }
+        }
+    }
 }
 
 
-inline bool shouldAccept(const SimulatedAnnealing::Candidate& candidate, const SimulatedAnnealing::Candidate& current, const float kTemperature)
+/* Tries to exchange the tours of neighbouring temperatures, alternating even and odd pairs between rounds. */
+template <typename Tour>
+inline void exchange(std::vector<Replica<Tour>>& replicas,
+                     const int round,
+                     std::vector<int>& attempts,
+                     std::vector<int>& accepts,
+                     Random& random)
 {
-    if (candidate.cost < current.cost)
+    for (size_t i = round % 2; i + 1 < replicas.size(); i += 2)
     {
-        return true;
+        Replica<Tour>& colder = replicas[i];
+        Replica<Tour>& hotter = replicas[i + 1];
+        const float exponent = (1.0f / colder.temperature - 1.0f / hotter.temperature) * (colder.currentCost - hotter.currentCost);
+        ++attempts[i];
+        if (exponent >= 0.0f || std::exp(exponent) > random.uniformFloat())
+        {
+            ++accepts[i];
+            std::swap(colder.current, hotter.current);
+            std::swap(colder.currentCost, hotter.currentCost);
+        }
     }
-    const float randomValue = static_cast<float>(rand()) / RAND_MAX;
-    return std::exp((current.cost - candidate.cost) / kTemperature) > randomValue;
 }
 
-} /* anonymous namespace */
+
+struct Speculation
+{
+    TwoOptMove move;
+    int offset; /* position of the accepted proposal in the round, -1 if all were rejected */
+};
 
 
-SimulatedAnnealing::Candidate SimulatedAnnealing::search(const std::vector<std::pair<float, float>>& cities,
-                                                         const int kIterLimit,
-                                                         const float kMaxTemperature,
-                                                         const float kTemperatureChange)
+/* Evaluates the proposals kBegin..kEnd of a round from the same current tour and stops at the first accepted one. */
+template <typename Tour, typename DistanceTable>
+inline void speculate(const DistanceTable& distances,
+                      const Tour& tour,
+                      const int kBegin,
+                      const int kEnd,
+                      float temperature,
+                      const float kTemperatureChange,
+                      Random& random,
+                      Speculation& result)
 {
-    srand(static_cast<unsigned>(time(nullptr)));
+    result.offset = -1;
+    for (int offset = kBegin; offset < kEnd; ++offset)
+    {
+        TwoOptMove move = stochasticTwoOpt(distances, tour, random);
+        temperature *= kTemperatureChange;
+        if (shouldAccept(move.delta, temperature, random))
+        {
+            result.move = move;
+            result.offset = offset;
+            return;
+        }
+    }
+}
+
+
+/*
+ * search() for one tour type and distance storage: Distances::dispatch() instantiates run() for the storage it picks.
+ * The tour is an ArrayTour or, from kTwoLevelListMinSize cities on, a TwoLevelListTour.
+ */
+template <typename Tour>
+struct Search
+{
+    template <typename DistanceTable>
+    static SimulatedAnnealing::Candidate run(const DistanceTable& distances,
+                                             const int kIterLimit,
+                                             const float kMaxTemperature,
+                                             const float kTemperatureChange,
+                                             const uint64_t kSeed);
+};
 
-    SimulatedAnnealing::Candidate current;
-    current.permutation = randomPermutation(cities);
-    current.cost = cost(cities, current.permutation);
 
-    SimulatedAnnealing::Candidate best = current;
+template <typename Tour>
+template <typename DistanceTable>
+SimulatedAnnealing::Candidate Search<Tour>::run(const DistanceTable& distances,
+                                                const int kIterLimit,
+                                                const float kMaxTemperature,
+                                                const float kTemperatureChange,
+                                                const uint64_t kSeed)
+{
+    Random random(kSeed);
+
+    SimulatedAnnealing::Candidate best;
+    best.permutation = randomPermutation(distances, random);
+    best.cost = cost(distances, best.permutation);
+    Tour current;
+    current.assign(best.permutation);
+    float currentCost = best.cost;
+
     float temperature = kMaxTemperature;
     for (int iter = 0; iter <= kIterLimit; ++iter)
     {
-        SimulatedAnnealing::Candidate candidate = createNeighbor(current, cities);
+        TwoOptMove move = stochasticTwoOpt(distances, current, random);
         temperature *= kTemperatureChange;
-        if (shouldAccept(candidate, current, temperature))
+        if (shouldAccept(move.delta, temperature, random))
         {
-            current = candidate;
+            applyTwoOpt(current, move);
+            currentCost += move.delta;
+            if (currentCost < best.cost)
+            {
+                current.permutation(best.permutation);
+                best.cost = currentCost;
+            }
         }
-        if (candidate.cost < best.cost)
+    }
+    best.cost = cost(distances, best.permutation);
+    return best;
+}
+
+
+/* searchParallelTempering() for one tour type and distance storage. */
+template <typename Tour>
+struct ParallelTempering
+{
+    template <typename DistanceTable>
+    static SimulatedAnnealing::TemperingResult run(const DistanceTable& distances,
+                                                   const int kIterLimit,
+                                                   const float kMinTemperature,
+                                                   const float kMaxTemperature,
+                                                   const size_t kReplicasCount,
+                                                   const int kExchangeInterval,
+                                                   const uint64_t kSeed);
+};
+
+
+template <typename Tour>
+template <typename DistanceTable>
+SimulatedAnnealing::TemperingResult ParallelTempering<Tour>::run(const DistanceTable& distances,
+                                                                 const int kIterLimit,
+                                                                 const float kMinTemperature,
+                                                                 const float kMaxTemperature,
+                                                                 const size_t kReplicasCount,
+                                                                 const int kExchangeInterval,
+                                                                 const uint64_t kSeed)
+{
+    Random random(kSeed);
+
+    std::vector<Replica<Tour>> replicas;
+    replicas.reserve(kReplicasCount);
+    for (size_t i = 0; i < kReplicasCount; ++i)
+    {
+        replicas.emplace_back(random.stream());
+    }
+    const float ratio = std::pow(kMaxTemperature / kMinTemperature, 1.0f / (kReplicasCount - 1));
+    for (size_t i = 0; i < replicas.size(); ++i)
+    {
+        Replica<Tour>& replica = replicas[i];
+        replica.temperature = kMinTemperature * std::pow(ratio, static_cast<float>(i));
+        replica.best.permutation = randomPermutation(distances, replica.random);
+        replica.best.cost = cost(distances, replica.best.permutation);
+        replica.current.assign(replica.best.permutation);
+        replica.currentCost = replica.best.cost;
+    }
+
+    const int rounds = (kIterLimit + kExchangeInterval - 1) / kExchangeInterval;
+    std::vector<int> attempts(replicas.size() - 1, 0),
+                     accepts(replicas.size() - 1, 0);
+    Barrier barrier(replicas.size());
+    std::vector<std::thread> workers;
+    workers.reserve(replicas.size());
+    for (size_t i = 0; i < replicas.size(); ++i)
+    {
+        workers.emplace_back([&, i]
         {
-            best.permutation.swap(candidate.permutation);
-            best.cost = candidate.cost;
+            for (int round = 0; round < rounds; ++round)
+            {
+                anneal(distances, replicas[i], std::min(kExchangeInterval, kIterLimit - round * kExchangeInterval));
+                barrier.wait([&] { exchange(replicas, round, attempts, accepts, random); });
+            }
+        });
+    }
+    for (size_t i = 0; i < workers.size(); ++i)
+    {
+        workers[i].join();
+    }
+
+    SimulatedAnnealing::TemperingResult result;
+    result.best = replicas.front().best;
+    for (size_t i = 1; i < replicas.size(); ++i)
+    {
+        if (replicas[i].best.cost < result.best.cost)
+        {
+            result.best = replicas[i].best;
         }
     }
+    result.best.cost = cost(distances, result.best.permutation);
+    result.swapRates.resize(attempts.size(), 0.0f);
+    for (size_t i = 0; i < attempts.size(); ++i)
+    {
+        if (attempts[i])
+        {
+            result.swapRates[i] = static_cast<float>(accepts[i]) / attempts[i];
+        }
+    }
+    return result;
+}
+
+
+/* searchSpeculative() for one tour type and distance storage. */
+template <typename Tour>
+struct Speculative
+{
+    template <typename DistanceTable>
+    static SimulatedAnnealing::Candidate run(const DistanceTable& distances,
+                                             const int kIterLimit,
+                                             const float kMaxTemperature,
+                                             const float kTemperatureChange,
+                                             const size_t kThreadsCount,
+                                             const int kBatchSize,
+                                             const uint64_t kSeed);
+};
+
+
+template <typename Tour>
+template <typename DistanceTable>
+SimulatedAnnealing::Candidate Speculative<Tour>::run(const DistanceTable& distances,
+                                                     const int kIterLimit,
+                                                     const float kMaxTemperature,
+                                                     const float kTemperatureChange,
+                                                     const size_t kThreadsCount,
+                                                     const int kBatchSize,
+                                                     const uint64_t kSeed)
+{
+    Random random(kSeed);
+    std::vector<Random> randoms;
+    randoms.reserve(kThreadsCount);
+    for (size_t i = 0; i < kThreadsCount; ++i)
+    {
+        randoms.push_back(random.stream());
+    }
+
+    SimulatedAnnealing::Candidate best;
+    best.permutation = randomPermutation(distances, randoms.front());
+    best.cost = cost(distances, best.permutation);
+    Tour current;
+    current.assign(best.permutation);
+    float currentCost = best.cost;
+
+    /* The steps of the serial chain are numbered 0..kIterLimit; a round speculates on kThreadsCount batches of them. */
+    const int kSteps = kIterLimit + 1;
+    const int kRoundSize = static_cast<int>(kThreadsCount) * kBatchSize;
+    int iter = 0;
+    std::vector<Speculation> speculations(kThreadsCount);
+    Barrier barrier(kThreadsCount);
+    auto commit = [&]
+    {
+        int offset = -1;
+        for (size_t i = 0; i < speculations.size() && offset == -1; ++i)
+        {
+            offset = speculations[i].offset;
+            if (offset != -1)
+            {
+                applyTwoOpt(current, speculations[i].move);
+                currentCost += speculations[i].move.delta;
+                if (currentCost < best.cost)
+                {
+                    current.permutation(best.permutation);
+                    best.cost = currentCost;
+                }
+            }
+        }
+        iter += offset == -1 ? kRoundSize : offset + 1;
+    };
+    auto worker = [&](const size_t index)
+    {
+        while (iter < kSteps)
+        {
+            const int begin = static_cast<int>(index) * kBatchSize;
+            const int end = std::min(begin + kBatchSize, kSteps - iter);
+            const float temperature = kMaxTemperature * std::pow(kTemperatureChange, static_cast<float>(iter + begin));
+            speculate(distances, current, begin, end, temperature, kTemperatureChange, randoms[index], speculations[index]);
+            barrier.wait(commit);
+        }
+    };
+
+    std::vector<std::thread> workers;
+    workers.reserve(kThreadsCount - 1);
+    for (size_t i = 1; i < kThreadsCount; ++i)
+    {
+        workers.emplace_back(worker, i);
+    }
+    worker(0);
+    for (size_t i = 0; i < workers.size(); ++i)
+    {
+        workers[i].join();
+    }
+
+    best.cost = cost(distances, best.permutation);
     return best;
 }
 
+} /* anonymous namespace */
+
+
+SimulatedAnnealing::Candidate SimulatedAnnealing::search(const std::vector<std::pair<float, float>>& cities,
+                                                         const int kIterLimit,
+                                                         const float kMaxTemperature,
+                                                         const float kTemperatureChange,
+                                                         const uint64_t kSeed)
+{
+    return search(TspInstance(cities), kIterLimit, kMaxTemperature, kTemperatureChange, kSeed);
+}
+
+
+SimulatedAnnealing::Candidate SimulatedAnnealing::search(const TspInstance& instance,
+                                                         const int kIterLimit,
+                                                         const float kMaxTemperature,
+                                                         const float kTemperatureChange,
+                                                         const uint64_t kSeed)
+{
+    if (instance.size() >= kTwoLevelListMinSize)
+    {
+        return Distances::dispatch<Search<TwoLevelListTour>>(instance, Distances::Policy::Auto, kIterLimit, kMaxTemperature,
+                                                             kTemperatureChange, kSeed);
+    }
+    return Distances::dispatch<Search<ArrayTour>>(instance, Distances::Policy::Auto, kIterLimit, kMaxTemperature, kTemperatureChange, kSeed);
+}
+
+
+SimulatedAnnealing::TemperingResult SimulatedAnnealing::searchParallelTempering(const TspInstance& instance,
+                                                                                const int kIterLimit,
+                                                                                const float kMinTemperature,
+                                                                                const float kMaxTemperature,
+                                                                                const size_t kReplicasCount,
+                                                                                const int kExchangeInterval,
+                                                                                const uint64_t kSeed)
+{
+    assert(kReplicasCount >= 2);
+    assert(kExchangeInterval > 0);
+    assert(kMinTemperature > 0.0f && kMinTemperature < kMaxTemperature);
+
+    if (instance.size() >= kTwoLevelListMinSize)
+    {
+        return Distances::dispatch<ParallelTempering<TwoLevelListTour>>(instance, Distances::Policy::Auto, kIterLimit, kMinTemperature,
+                                                                        kMaxTemperature, kReplicasCount, kExchangeInterval, kSeed);
+    }
+    return Distances::dispatch<ParallelTempering<ArrayTour>>(instance, Distances::Policy::Auto, kIterLimit, kMinTemperature,
+                                                             kMaxTemperature, kReplicasCount, kExchangeInterval, kSeed);
+}
+
+
+SimulatedAnnealing::Candidate SimulatedAnnealing::searchSpeculative(const TspInstance& instance,
+                                                                    const int kIterLimit,
+                                                                    const float kMaxTemperature,
+                                                                    const float kTemperatureChange,
+                                                                    const size_t kThreadsCount,
+                                                                    const int kBatchSize,
+                                                                    const uint64_t kSeed)
+{
+    assert(kThreadsCount >= 1);
+    assert(kBatchSize > 0);
+
+    if (instance.size() >= kTwoLevelListMinSize)
+    {
+        return Distances::dispatch<Speculative<TwoLevelListTour>>(instance, Distances::Policy::Auto, kIterLimit, kMaxTemperature,
+                                                                  kTemperatureChange, kThreadsCount, kBatchSize, kSeed);
+    }
+    return Distances::dispatch<Speculative<ArrayTour>>(instance, Distances::Policy::Auto, kIterLimit, kMaxTemperature,
+                                                       kTemperatureChange, kThreadsCount, kBatchSize, kSeed);
+}
+
 } /* namespace CleverAlgorithms */
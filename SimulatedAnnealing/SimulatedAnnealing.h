@@ -8,8 +8,11 @@
 #define SIMULATEDANNEALING_H_7995D012_57FC_11E5_A91D_C038963D1C06
 
 
+#include <cstdint>
 #include <vector>
 
+#include "../Common/TspInstance.h"
+
 
 namespace CleverAlgorithms
 {
@@ -25,10 +28,49 @@ public:
     };
 
 
+    struct TemperingResult
+    {
+        Candidate best;
+        std::vector<float> swapRates; /* swapRates[i]: acceptance rate of exchanges between temperatures i and i + 1 */
+    };
+
+
     static Candidate search(const std::vector<std::pair<float, float>>& cities,
                             const int kIterLimit,
                             const float kMaxTemperature,
-                            const float kTemperatureChange);
+                            const float kTemperatureChange,
+                            const uint64_t kSeed);
+
+    static Candidate search(const TspInstance& instance,
+                            const int kIterLimit,
+                            const float kMaxTemperature,
+                            const float kTemperatureChange,
+                            const uint64_t kSeed);
+
+    /*
+     * Replica exchange: kReplicasCount chains on their own threads at fixed temperatures spaced geometrically from
+     * kMinTemperature to kMaxTemperature. Every kExchangeInterval of the kIterLimit steps the chains meet at a barrier
+     * and neighbouring temperatures try to swap tours.
+     */
+    static TemperingResult searchParallelTempering(const TspInstance& instance,
+                                                   const int kIterLimit,
+                                                   const float kMinTemperature,
+                                                   const float kMaxTemperature,
+                                                   const size_t kReplicasCount,
+                                                   const int kExchangeInterval,
+                                                   const uint64_t kSeed);
+
+    /*
+     * The same chain as search(), with kThreadsCount threads each evaluating kBatchSize proposals from the current tour
+     * per round. The first accepted proposal in step order is committed and the later ones are discarded.
+     */
+    static Candidate searchSpeculative(const TspInstance& instance,
+                                       const int kIterLimit,
+                                       const float kMaxTemperature,
+                                       const float kTemperatureChange,
+                                       const size_t kThreadsCount,
+                                       const int kBatchSize,
+                                       const uint64_t kSeed);
 };
 
 } /* namespace CleverAlgorithms */
@@ -4,6 +4,7 @@
  */
 
 
+#include <ctime>
 #include <iostream>
 #include <vector>
 
@@ -31,7 +32,8 @@ int main()
 {
     const int kBitsCount = 64;
     const int kIterLimit = 192;
-    CleverAlgorithms::StochasticHillClimbing::Candidate result = CleverAlgorithms::StochasticHillClimbing::search(kIterLimit, kBitsCount);
+    const uint64_t kSeed = static_cast<uint64_t>(time(nullptr));
+    CleverAlgorithms::StochasticHillClimbing::Candidate result = CleverAlgorithms::StochasticHillClimbing::search(kIterLimit, kBitsCount, kSeed);
     printResult(result);
     return 0;
 }
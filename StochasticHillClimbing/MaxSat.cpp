@@ -0,0 +1,174 @@
+/*
+ * Filename: MaxSat.cpp
+ * Author:   Michael Tkach (x1mike7x@gmail.com)
+ */
+
+
+#include <algorithm>
+#include <cassert>
+#include <cstdlib>
+
+#include "MaxSat.h"
+#include "../Common/Random.h"
+
+
+namespace CleverAlgorithms
+{
+
+namespace
+{
+
+/* Orders literals by variable and puts the negation first, so repeats and complements end up next to each other. */
+inline bool literalLess(const int left, const int right)
+{
+    return std::abs(left) != std::abs(right) ? std::abs(left) < std::abs(right) : left < right;
+}
+
+} /* anonymous namespace */
+
+
+MaxSat::MaxSat(const size_t variablesCount, const std::vector<std::vector<int>>& clauses, const std::vector<double>& weights)
+    : offsets_(variablesCount + 1, 0)
+    , tautologiesWeight_(0.0)
+{
+    assert(clauses.size() == weights.size());
+
+    /* A repeated literal would be counted twice in trueCounts_ and a tautology has no flip that changes it. */
+    clauses_.reserve(clauses.size());
+    weights_.reserve(weights.size());
+    std::vector<int> clause;
+    for (size_t c = 0; c < clauses.size(); ++c)
+    {
+        clause = clauses[c];
+        std::sort(clause.begin(), clause.end(), literalLess);
+        clause.erase(std::unique(clause.begin(), clause.end()), clause.end());
+        bool tautology = false;
+        for (size_t i = 0; i + 1 < clause.size() && !tautology; ++i)
+        {
+            tautology = clause[i] == -clause[i + 1];
+        }
+        if (tautology)
+        {
+            tautologiesWeight_ += weights[c];
+            continue;
+        }
+        for (size_t i = 0; i < clause.size(); ++i)
+        {
+            assert(clause[i] && static_cast<size_t>(std::abs(clause[i])) <= variablesCount);
+
+            ++offsets_[std::abs(clause[i])];
+        }
+        clauses_.push_back(clause);
+        weights_.push_back(weights[c]);
+    }
+    trueCounts_.assign(clauses_.size(), 0);
+    for (size_t v = 0; v < variablesCount; ++v)
+    {
+        offsets_[v + 1] += offsets_[v];
+    }
+    occurrences_.resize(offsets_.back());
+    std::vector<size_t> next(offsets_.begin(), offsets_.end() - 1);
+    for (size_t c = 0; c < clauses_.size(); ++c)
+    {
+        for (size_t i = 0; i < clauses_[c].size(); ++i)
+        {
+            Occurrence& occurrence = occurrences_[next[std::abs(clauses_[c][i]) - 1]++];
+            occurrence.clause = static_cast<uint32_t>(c);
+            occurrence.positive = clauses_[c][i] > 0;
+        }
+    }
+}
+
+
+MaxSat MaxSat::generate(const size_t variablesCount, const size_t clausesCount, const size_t literalsPerClause, const uint64_t kSeed)
+{
+    assert(literalsPerClause <= variablesCount);
+
+    Random random(kSeed);
+
+    std::vector<std::vector<int>> clauses(clausesCount);
+    std::vector<double> weights(clausesCount);
+    for (size_t c = 0; c < clausesCount; ++c)
+    {
+        std::vector<int>& clause = clauses[c];
+        while (clause.size() < literalsPerClause)
+        {
+            const int variable = static_cast<int>(random.uniformInt(static_cast<uint32_t>(variablesCount))) + 1;
+            if (std::find(clause.begin(), clause.end(), variable) == clause.end() &&
+                std::find(clause.begin(), clause.end(), -variable) == clause.end())
+            {
+                clause.push_back(random.uniformInt(2) ? variable : -variable);
+            }
+        }
+        weights[c] = random.uniformFloat(1.0f, 2.0f);
+    }
+    return MaxSat(variablesCount, clauses, weights);
+}
+
+
+double MaxSat::evaluate(const BitString& bits)
+{
+    assert(bits.size() == size());
+
+    double res = tautologiesWeight_;
+    for (size_t c = 0; c < clauses_.size(); ++c)
+    {
+        trueCounts_[c] = 0;
+        for (size_t i = 0; i < clauses_[c].size(); ++i)
+        {
+            const int literal = clauses_[c][i];
+            if (bits[std::abs(literal) - 1] == (literal > 0))
+            {
+                ++trueCounts_[c];
+            }
+        }
+        if (trueCounts_[c])
+        {
+            res += weights_[c];
+        }
+    }
+    return res;
+}
+
+
+double MaxSat::flipDelta(const BitString& bits, const size_t pos) const
+{
+    const bool value = bits[pos];
+    double res = 0.0;
+    for (size_t i = offsets_[pos]; i < offsets_[pos + 1]; ++i)
+    {
+        const uint32_t clause = occurrences_[i].clause;
+        if (occurrences_[i].positive == value)
+        {
+            if (trueCounts_[clause] == 1)
+            {
+                res -= weights_[clause];
+            }
+        }
+        else if (!trueCounts_[clause])
+        {
+            res += weights_[clause];
+        }
+    }
+    return res;
+}
+
+
+void MaxSat::applyFlip(BitString& bits, const size_t pos)
+{
+    const bool value = bits[pos];
+    for (size_t i = offsets_[pos]; i < offsets_[pos + 1]; ++i)
+    {
+        if (occurrences_[i].positive == value)
+        {
+            --trueCounts_[occurrences_[i].clause];
+        }
+        else
+        {
+            ++trueCounts_[occurrences_[i].clause];
+        }
+    }
+    bits.flip(pos);
+}
+
+} /* namespace CleverAlgorithms */
@@ -0,0 +1,67 @@
+/*
+ * Filename: MaxSat.h
+ * Author:   Michael Tkach (x1mike7x@gmail.com)
+ */
+
+
+#ifndef MAXSAT_H_C4C659E6_C9F3_11F1_AB2D_C038963D1C06
+#define MAXSAT_H_C4C659E6_C9F3_11F1_AB2D_C038963D1C06
+
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "../Common/BitString.h"
+
+
+namespace CleverAlgorithms
+{
+
+/*
+ * Weighted MAX-SAT: the fitness is the total weight of the satisfied clauses. Literals are DIMACS style, +(v + 1)
+ * for variable v and -(v + 1) for its negation. The number of true literals of every clause is kept up to date, so
+ * a flip touches only the clauses the flipped variable occurs in. The constructor drops repeated literals of a clause
+ * and sets tautologies aside, since every assignment satisfies them: they only add their weight to the fitness.
+ */
+class MaxSat
+{
+public:
+
+    MaxSat(const size_t variablesCount, const std::vector<std::vector<int>>& clauses, const std::vector<double>& weights);
+
+    /* Random instance of clausesCount clauses over distinct variables with weights uniform in [1, 2). */
+    static MaxSat generate(const size_t variablesCount, const size_t clausesCount, const size_t literalsPerClause, const uint64_t kSeed);
+
+    size_t size() const
+    {
+        return offsets_.size() - 1;
+    }
+
+    /* Full evaluation; also resets the bookkeeping to bits. */
+    double evaluate(const BitString& bits);
+
+    double flipDelta(const BitString& bits, const size_t pos) const;
+
+    void applyFlip(BitString& bits, const size_t pos);
+
+private:
+
+    struct Occurrence
+    {
+        uint32_t clause;
+        bool positive;
+    };
+
+
+    std::vector<std::vector<int>> clauses_;
+    std::vector<double> weights_;
+    std::vector<size_t> offsets_;
+    std::vector<Occurrence> occurrences_;
+    std::vector<uint32_t> trueCounts_;
+    double tautologiesWeight_;
+};
+
+} /* namespace CleverAlgorithms */
+
+#endif /* MAXSAT_H_C4C659E6_C9F3_11F1_AB2D_C038963D1C06 */
@@ -0,0 +1,107 @@
+/*
+ * Filename: NkLandscape.cpp
+ * Author:   Michael Tkach (x1mike7x@gmail.com)
+ */
+
+
+#include <algorithm>
+#include <cassert>
+
+#include "NkLandscape.h"
+#include "../Common/Random.h"
+
+
+namespace CleverAlgorithms
+{
+
+NkLandscape::NkLandscape(const size_t n, const size_t k, const uint64_t kSeed)
+    : k_(k)
+    , loci_(n * (k + 1))
+    , contributions_(n << (k + 1))
+    , offsets_(n + 1, 0)
+    , occurrences_(n * (k + 1))
+    , indices_(n, 0)
+{
+    assert(k < n && k < 31);
+
+    Random random(kSeed);
+
+    /* Locus i reads bit i first and then k distinct other bits. */
+    for (size_t i = 0; i < n; ++i)
+    {
+        uint32_t* loci = &loci_[i * (k + 1)];
+        loci[0] = static_cast<uint32_t>(i);
+        for (size_t j = 1; j <= k; ++j)
+        {
+            do
+            {
+                loci[j] = random.uniformInt(static_cast<uint32_t>(n));
+            }
+            while (std::find(loci, loci + j, loci[j]) != loci + j);
+        }
+    }
+    random.fill(contributions_.data(), contributions_.data() + contributions_.size(), 0.0f, 1.0f);
+
+    for (size_t i = 0; i < loci_.size(); ++i)
+    {
+        ++offsets_[loci_[i] + 1];
+    }
+    for (size_t i = 0; i < n; ++i)
+    {
+        offsets_[i + 1] += offsets_[i];
+    }
+    std::vector<size_t> next(offsets_.begin(), offsets_.end() - 1);
+    for (size_t i = 0; i < n; ++i)
+    {
+        for (size_t j = 0; j <= k; ++j)
+        {
+            Occurrence& occurrence = occurrences_[next[loci_[i * (k + 1) + j]]++];
+            occurrence.locus = static_cast<uint32_t>(i);
+            occurrence.mask = static_cast<uint32_t>(1) << j;
+        }
+    }
+}
+
+
+double NkLandscape::evaluate(const BitString& bits)
+{
+    assert(bits.size() == size());
+
+    double res = 0.0;
+    for (size_t i = 0; i < size(); ++i)
+    {
+        uint32_t index = 0;
+        for (size_t j = 0; j <= k_; ++j)
+        {
+            index |= static_cast<uint32_t>(bits[loci_[i * (k_ + 1) + j]]) << j;
+        }
+        indices_[i] = index;
+        res += contributions_[(i << (k_ + 1)) | index];
+    }
+    return res / static_cast<double>(size());
+}
+
+
+double NkLandscape::flipDelta(const BitString&, const size_t pos) const
+{
+    double res = 0.0;
+    for (size_t i = offsets_[pos]; i < offsets_[pos + 1]; ++i)
+    {
+        const size_t table = static_cast<size_t>(occurrences_[i].locus) << (k_ + 1);
+        const uint32_t index = indices_[occurrences_[i].locus];
+        res += contributions_[table | (index ^ occurrences_[i].mask)] - contributions_[table | index];
+    }
+    return res / static_cast<double>(size());
+}
+
+
+void NkLandscape::applyFlip(BitString& bits, const size_t pos)
+{
+    for (size_t i = offsets_[pos]; i < offsets_[pos + 1]; ++i)
+    {
+        indices_[occurrences_[i].locus] ^= occurrences_[i].mask;
+    }
+    bits.flip(pos);
+}
+
+} /* namespace CleverAlgorithms */
@@ -0,0 +1,63 @@
+/*
+ * Filename: NkLandscape.h
+ * Author:   Michael Tkach (x1mike7x@gmail.com)
+ */
+
+
+#ifndef NKLANDSCAPE_H_C4C65994_C9F3_11F1_9232_C038963D1C06
+#define NKLANDSCAPE_H_C4C65994_C9F3_11F1_9232_C038963D1C06
+
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "../Common/BitString.h"
+
+
+namespace CleverAlgorithms
+{
+
+/*
+ * NK landscape: the fitness is the mean of n contributions, and contribution i is a random table lookup on bit i
+ * and k other random bits. The table index of every locus is kept up to date, so a flip touches only the loci that
+ * read the flipped bit.
+ */
+class NkLandscape
+{
+public:
+
+    NkLandscape(const size_t n, const size_t k, const uint64_t kSeed);
+
+    size_t size() const
+    {
+        return indices_.size();
+    }
+
+    /* Full evaluation; also resets the bookkeeping to bits. */
+    double evaluate(const BitString& bits);
+
+    double flipDelta(const BitString& bits, const size_t pos) const;
+
+    void applyFlip(BitString& bits, const size_t pos);
+
+private:
+
+    struct Occurrence
+    {
+        uint32_t locus;
+        uint32_t mask;
+    };
+
+
+    size_t k_;
+    std::vector<uint32_t> loci_;
+    std::vector<float> contributions_;
+    std::vector<size_t> offsets_;
+    std::vector<Occurrence> occurrences_;
+    std::vector<uint32_t> indices_;
+};
+
+} /* namespace CleverAlgorithms */
+
+#endif /* NKLANDSCAPE_H_C4C65994_C9F3_11F1_9232_C038963D1C06 */
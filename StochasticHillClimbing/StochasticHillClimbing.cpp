@@ -4,9 +4,12 @@
  */
 
 
+#include <algorithm>
+#include <atomic>
 #include <cassert>
-#include <cstdlib>
-#include <ctime>
+#include <functional>
+#include <thread>
+#include <vector>
 
 #include "StochasticHillClimbing.h"
 
@@ -14,64 +17,134 @@
 namespace CleverAlgorithms
 {
 
-namespace
+StochasticHillClimbing::Candidate StochasticHillClimbing::search(const int kIterLimit, const int kBitsCount, const uint64_t kSeed)
 {
+    assert(kBitsCount > 0);
 
-inline int onemax(const std::vector<bool>& values)
+    Random random(kSeed);
+
+    StochasticHillClimbing::Candidate best;
+    best.values = BitString(kBitsCount);
+    randomize(best.values, random);
+    climb(kIterLimit, random, best);
+    return best;
+}
+
+
+/*
+ * Restart r climbs with the r-th stream of random, so a restart sees the same numbers whichever thread runs it.
+ * Runs every kStride-th restart from kFirst on and keeps the best of them in result.
+ */
+void StochasticHillClimbing::restarts(const int kIterLimit,
+                                      const int kBitsCount,
+                                      const int kFirst,
+                                      const int kStride,
+                                      const int kRestartsCount,
+                                      Random random,
+                                      std::atomic<int>& bestCost,
+                                      Candidate& result)
 {
-    int res = 0;
-    for (size_t i = 0; i < values.size(); ++i)
+    for (int skip = 0; skip < kFirst; ++skip)
     {
-        if (values[i])
+        (void)random.stream();
+    }
+    result.values = BitString();
+    for (int restart = kFirst; restart < kRestartsCount && bestCost.load(std::memory_order_relaxed) < kBitsCount; restart += kStride)
+    {
+        Random restartRandom = random.stream();
+        StochasticHillClimbing::Candidate candidate;
+        candidate.values = BitString(kBitsCount);
+        randomize(candidate.values, restartRandom);
+        climb(kIterLimit, restartRandom, candidate);
+        if (!result.values.size() || candidate.cost > result.cost)
+        {
+            result = candidate;
+            int current = bestCost.load(std::memory_order_relaxed);
+            while (result.cost > current && !bestCost.compare_exchange_weak(current, result.cost, std::memory_order_relaxed))
+            {
+            }
+        }
+        for (int skip = 1; skip < kStride; ++skip)
         {
-            ++res;
+            (void)random.stream();
         }
     }
-    return res;
 }
 
 
-inline std::vector<bool> randomBits(const int kBitsCount)
+StochasticHillClimbing::Candidate StochasticHillClimbing::searchParallel(const int kIterLimit,
+                                                                         const int kBitsCount,
+                                                                         const int kRestartsCount,
+                                                                         const unsigned kThreadsCount,
+                                                                         const uint64_t kSeed)
 {
-    std::vector<bool> res(kBitsCount);
-    for (int i = 0; i < kBitsCount; ++i)
-    {
-        res[i] = rand() > (RAND_MAX / 2);
-    }
-    return res;
-}
+    assert(kRestartsCount > 0);
 
+    const unsigned threadsCount = std::max(1u, std::min(kThreadsCount, static_cast<unsigned>(kRestartsCount)));
+    Random random(kSeed);
 
-inline std::vector<bool> randomNeighbor(const std::vector<bool>& current)
-{
-    assert(!current.empty());
+    std::atomic<int> bestCost(-1);
+    std::vector<StochasticHillClimbing::Candidate> results(threadsCount);
+    std::vector<std::thread> workers;
+    workers.reserve(threadsCount - 1);
+    for (unsigned i = 1; i < threadsCount; ++i)
+    {
+        workers.emplace_back(restarts, kIterLimit, kBitsCount, static_cast<int>(i), static_cast<int>(threadsCount), kRestartsCount,
+                             random, std::ref(bestCost), std::ref(results[i]));
+    }
+    restarts(kIterLimit, kBitsCount, 0, static_cast<int>(threadsCount), kRestartsCount, random, bestCost, results[0]);
+    for (size_t i = 0; i < workers.size(); ++i)
+    {
+        workers[i].join();
+    }
 
-    std::vector<bool> mutant(current);
-    size_t pos = rand() % current.size();
-    mutant[pos] = !mutant[pos];
-    return mutant;
+    StochasticHillClimbing::Candidate best;
+    for (size_t i = 0; i < results.size(); ++i)
+    {
+        if (results[i].values.size() && (!best.values.size() || results[i].cost > best.cost))
+        {
+            best = results[i];
+        }
+    }
+    return best;
 }
 
-} /* anonymous namespace */
 
-
-StochasticHillClimbing::Candidate StochasticHillClimbing::search(const int kIterLimit, const int kBitsCount)
+/*
+ * For OneMax every zero bit gains one and every one bit loses one, so the best flips are exactly the zero bits. Each
+ * step draws one of them uniformly: whole words are skipped by their zero count and the chosen word is searched.
+ */
+StochasticHillClimbing::Candidate StochasticHillClimbing::searchSteepest(const int kIterLimit, const int kBitsCount, const uint64_t kSeed)
 {
-    srand(static_cast<unsigned>(time(nullptr)));
+    assert(kBitsCount > 0);
+
+    Random random(kSeed);
 
     StochasticHillClimbing::Candidate best;
-    best.values = randomBits(kBitsCount);
-    best.cost = onemax(best.values);
-    for (int iter = 0; iter < kIterLimit; ++iter)
+    best.values = BitString(kBitsCount);
+    randomize(best.values, random);
+    best.cost = static_cast<int>(best.values.count());
+
+    const std::vector<uint64_t>& words = best.values.words();
+    const size_t tailBits = best.values.size() % BitString::kWordBits;
+    const uint64_t tailMask = tailBits ? (static_cast<uint64_t>(1) << tailBits) - 1 : ~static_cast<uint64_t>(0);
+    for (int iter = 0; iter < kIterLimit && best.cost < kBitsCount; ++iter)
     {
-        StochasticHillClimbing::Candidate neighbor;
-        neighbor.values = randomNeighbor(best.values);
-        neighbor.cost = onemax(neighbor.values);
-        if (neighbor.cost > best.cost)
+        size_t rank = random.uniformInt(static_cast<uint32_t>(kBitsCount - best.cost));
+        size_t word = 0;
+        uint64_t zeros = ~words[word] & (word + 1 == words.size() ? tailMask : ~static_cast<uint64_t>(0));
+        for (size_t count = BitString::popCount(zeros); rank >= count; count = BitString::popCount(zeros))
+        {
+            rank -= count;
+            ++word;
+            zeros = ~words[word] & (word + 1 == words.size() ? tailMask : ~static_cast<uint64_t>(0));
+        }
+        for (; rank; --rank)
         {
-            best.values.swap(neighbor.values);
-            best.cost = neighbor.cost;
+            zeros &= zeros - 1;
         }
+        best.values.flip(word * BitString::kWordBits + BitString::lowestBit(zeros));
+        ++best.cost;
     }
     return best;
 }
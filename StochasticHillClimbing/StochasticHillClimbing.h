@@ -8,7 +8,14 @@
 #define STOCHASTICHILLCLIMBING_H_53DDEA50_28BD_11E5_9058_C038963D1C06
 
 
-#include <vector>
+#include <atomic>
+#include <bitset>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+
+#include "../Common/BitString.h"
+#include "../Common/Random.h"
 
 
 namespace CleverAlgorithms
@@ -18,16 +25,189 @@ class StochasticHillClimbing
 {
 public:
 
-    struct Candidate
+    template <typename Bits, typename Cost = int>
+    struct BasicCandidate
     {
-        std::vector<bool> values;
-        int cost;
+        Bits values;
+        Cost cost;
     };
 
+    typedef BasicCandidate<BitString> Candidate;
+
+    /* Bit string of a length known at compile time. */
+    template <size_t N>
+    using FixedCandidate = BasicCandidate<std::bitset<N>>;
+
+    typedef BasicCandidate<BitString, double> ProblemCandidate;
+
+
+    static Candidate search(const int kIterLimit, const int kBitsCount, const uint64_t kSeed);
+
+    template <size_t N>
+    static FixedCandidate<N> search(const int kIterLimit, const uint64_t kSeed);
+
+    /*
+     * Maximizes any pseudo-boolean problem with delta evaluation, e.g. NkLandscape or MaxSat. Problem provides
+     * size(), evaluate(bits) that also resets its bookkeeping, flipDelta(bits, pos) and applyFlip(bits, pos), so an
+     * iteration costs only the terms the flipped bit takes part in.
+     */
+    template <typename Problem>
+    static ProblemCandidate search(Problem& problem, const int kIterLimit, const uint64_t kSeed);
+
+    /*
+     * Runs kRestartsCount independent climbs round-robin across kThreadsCount threads, each climb with its own random
+     * stream. The threads share the best cost and stop restarting once any of them has reached all ones.
+     */
+    static Candidate searchParallel(const int kIterLimit,
+                                    const int kBitsCount,
+                                    const int kRestartsCount,
+                                    const unsigned kThreadsCount,
+                                    const uint64_t kSeed);
+
+    /* Steepest ascent: every step takes one of the best flips uniformly at random; zero bits are counted 64 at a time. */
+    static Candidate searchSteepest(const int kIterLimit, const int kBitsCount, const uint64_t kSeed);
+
+    /* Steepest ascent on a problem: every step evaluates flipDelta for all positions and applies the best, ties broken uniformly. */
+    template <typename Problem>
+    static ProblemCandidate searchSteepest(Problem& problem, const int kIterLimit, const uint64_t kSeed);
 
-    static Candidate search(const int kIterLimit, const int kBitsCount);
+private:
+
+    static void randomize(BitString& bits, Random& random)
+    {
+        bits.randomize(random);
+    }
+
+    template <size_t N>
+    static void randomize(std::bitset<N>& bits, Random& random)
+    {
+        for (size_t i = 0; i < N; i += BitString::kWordBits)
+        {
+            const uint64_t word = random();
+            for (size_t j = i; j < N && j < i + BitString::kWordBits; ++j)
+            {
+                bits[j] = (word >> (j - i)) & 1;
+            }
+        }
+    }
+
+    template <typename Bits>
+    static void climb(const int kIterLimit, Random& random, BasicCandidate<Bits>& best);
+
+    static void restarts(const int kIterLimit,
+                         const int kBitsCount,
+                         const int kFirst,
+                         const int kStride,
+                         const int kRestartsCount,
+                         Random random,
+                         std::atomic<int>& bestCost,
+                         Candidate& result);
 };
 
+
+template <size_t N>
+StochasticHillClimbing::FixedCandidate<N> StochasticHillClimbing::search(const int kIterLimit, const uint64_t kSeed)
+{
+    Random random(kSeed);
+
+    FixedCandidate<N> best;
+    randomize(best.values, random);
+    climb(kIterLimit, random, best);
+    return best;
+}
+
+
+template <typename Problem>
+StochasticHillClimbing::ProblemCandidate StochasticHillClimbing::search(Problem& problem, const int kIterLimit, const uint64_t kSeed)
+{
+    assert(problem.size());
+
+    Random random(kSeed);
+
+    ProblemCandidate best;
+    best.values = BitString(problem.size());
+    randomize(best.values, random);
+    best.cost = problem.evaluate(best.values);
+    for (int iter = 0; iter < kIterLimit; ++iter)
+    {
+        const size_t pos = random.uniformInt(static_cast<uint32_t>(best.values.size()));
+        const double delta = problem.flipDelta(best.values, pos);
+        if (delta > 0.0)
+        {
+            problem.applyFlip(best.values, pos);
+            best.cost += delta;
+        }
+    }
+    return best;
+}
+
+
+template <typename Problem>
+StochasticHillClimbing::ProblemCandidate StochasticHillClimbing::searchSteepest(Problem& problem, const int kIterLimit, const uint64_t kSeed)
+{
+    assert(problem.size());
+
+    Random random(kSeed);
+
+    ProblemCandidate best;
+    best.values = BitString(problem.size());
+    randomize(best.values, random);
+    best.cost = problem.evaluate(best.values);
+    for (int iter = 0; iter < kIterLimit; ++iter)
+    {
+        size_t bestPos = 0;
+        double bestDelta = problem.flipDelta(best.values, 0);
+        uint32_t ties = 1;
+        for (size_t pos = 1; pos < best.values.size(); ++pos)
+        {
+            const double delta = problem.flipDelta(best.values, pos);
+            if (delta > bestDelta)
+            {
+                bestPos = pos;
+                bestDelta = delta;
+                ties = 1;
+            }
+            else if (delta == bestDelta && !random.uniformInt(++ties))
+            {
+                /* Reservoir sampling: each of the tied positions ends up chosen with probability 1 / ties. */
+                bestPos = pos;
+            }
+        }
+        if (bestDelta <= 0.0)
+        {
+            break;
+        }
+        problem.applyFlip(best.values, bestPos);
+        best.cost += bestDelta;
+    }
+    return best;
+}
+
+
+/*
+ * OneMax: a flip changes the fitness by exactly one, so each iteration flips one bit in place, takes the new
+ * fitness from the old and flips the bit back if it got worse.
+ */
+template <typename Bits>
+void StochasticHillClimbing::climb(const int kIterLimit, Random& random, BasicCandidate<Bits>& best)
+{
+    best.cost = static_cast<int>(best.values.count());
+    for (int iter = 0; iter < kIterLimit; ++iter)
+    {
+        const size_t pos = random.uniformInt(static_cast<uint32_t>(best.values.size()));
+        best.values.flip(pos);
+        const int cost = best.values[pos] ? best.cost + 1 : best.cost - 1;
+        if (cost > best.cost)
+        {
+            best.cost = cost;
+        }
+        else
+        {
+            best.values.flip(pos);
+        }
+    }
+}
+
 } /* namespace CleverAlgorithms */
 
 #endif /* STOCHASTICHILLCLIMBING_H_53DDEA50_28BD_11E5_9058_C038963D1C06 */
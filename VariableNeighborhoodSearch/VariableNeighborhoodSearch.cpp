@@ -6,11 +6,13 @@
 
 #include <algorithm>
 #include <cassert>
-#include <cstdlib>
-#include <ctime>
-#include <set>
+#include <numeric>
 
 #include "VariableNeighborhoodSearch.h"
+#include "../Common/ArrayTour.h"
+#include "../Common/Distances.h"
+#include "../Common/Random.h"
+#include "../Common/TwoLevelListTour.h"
 
 
 namespace CleverAlgorithms
@@ -19,17 +21,10 @@ namespace CleverAlgorithms
 namespace
 {
 
-inline float euc2d(const std::pair<float, float>& a, const std::pair<float, float>& b)
+template <typename DistanceTable>
+inline float cost(const DistanceTable& distances, const std::vector<int>& permutation)
 {
-    float dx = a.first - b.first;
-    float dy = a.second - b.second;
-    return std::sqrt(dx * dx + dy * dy);
-}
-
-
-inline float cost(const std::vector<std::pair<float, float>>& cities, const std::vector<int>& permutation)
-{
-    assert(cities.size() == permutation.size());
+    assert(distances.size() == permutation.size());
 
     float distance = 0.0f;
     for (size_t i = 0; i < permutation.size(); ++i)
@@ -37,116 +32,222 @@ inline float cost(const std::vector<std::pair<float, float>>& cities, const std:
         int j = i + 1 == permutation.size() ? 0 : i + 1;
         int c1 = permutation[i],
             c2 = permutation[j];
-        distance += euc2d(cities[c1], cities[c2]);
+        distance += distances(c1, c2);
     }
     return distance;
 }
 
 
-inline std::vector<int> randomPermutation(const std::vector<std::pair<float, float>>& cities)
+template <typename DistanceTable>
+inline std::vector<int> randomPermutation(const DistanceTable& distances, Random& random)
 {
-    std::vector<int> res(cities.size());
+    std::vector<int> res(distances.size());
     std::iota(res.begin(), res.end(), 0);
     for (size_t i = 0; i < res.size(); ++i)
     {
-        size_t r = rand() % (res.size() - i) + i;
+        size_t r = random.uniformInt(static_cast<uint32_t>(res.size() - i)) + i;
         std::swap(res[i], res[r]);
     }
     return res;
 }
 
 
-inline void stochasticTwoOpt(std::vector<int>& permutation)
+/* A 2-opt move that replaced the tour edges (t1, t2) and (t3, t4), t2 and t4 following t1 and t3 in one direction. */
+struct TwoOptMove
+{
+    int t1;
+    int t2;
+    int t3;
+    int t4;
+};
+
+
+/*
+ * Replaces the edges (t1, t2) and (t3, t4) with (t1, t3) and (t2, t4) by reversing the path t2..t3. The tour may
+ * have been reversed as a whole by an earlier move, so the direction is read from the tour.
+ */
+template <typename Tour>
+inline void exchange(Tour& tour, const int t1, const int t2, const int t3, const int t4, std::vector<TwoOptMove>& log)
+{
+    if (tour.next(t1) == t2)
+    {
+        tour.reverse(t2, t3);
+    }
+    else
+    {
+        tour.reverse(t3, t2);
+    }
+    const TwoOptMove move = {t1, t2, t3, t4};
+    log.push_back(move);
+}
+
+
+/* Undoes the moves logged after the first kMark ones, last first. */
+template <typename Tour>
+inline void rollback(Tour& tour, std::vector<TwoOptMove>& log, const size_t kMark)
 {
-    assert(permutation.size() >= 4);
-
-    size_t c1 = rand() % permutation.size(),
-           c2 = rand() % permutation.size();
-    std::set<size_t> exclude;
-    exclude.insert(c1);
-    exclude.insert(c1 ? c1 - 1 : permutation.size() - 1);
-    exclude.insert(c1 + 1 < permutation.size() ? c1 + 1 : 0);
-    while (exclude.count(c2))
+    while (log.size() > kMark)
     {
-        c2 = rand() % permutation.size();
+        const TwoOptMove move = log.back();
+        log.pop_back();
+        if (tour.next(move.t1) == move.t3)
+        {
+            tour.reverse(move.t3, move.t2);
+        }
+        else
+        {
+            tour.reverse(move.t2, move.t3);
+        }
     }
-    if (c1 > c2)
+}
+
+
+/* Applies a random 2-opt move to the tour, logs it and returns the cost change from the four touched edges. */
+template <typename Tour, typename DistanceTable>
+inline float stochasticTwoOpt(Tour& tour, const DistanceTable& distances, Random& random, std::vector<TwoOptMove>& log)
+{
+    assert(tour.size() >= 4);
+
+    const uint32_t n = static_cast<uint32_t>(tour.size());
+    const int b = random.uniformInt(n);
+    const int a = tour.prev(b),
+              next = tour.next(b);
+    int d = random.uniformInt(n);
+    while (d == b || d == a || d == next)
     {
-        std::swap(c1, c2);
+        d = random.uniformInt(n);
     }
-    std::reverse(permutation.begin() + c1, permutation.begin() + c2);
+    const int c = tour.prev(d);
+
+    const float delta = distances(a, c) + distances(b, d)
+                      - distances(a, b) - distances(c, d);
+    exchange(tour, a, b, c, d, log);
+    return delta;
 }
 
 
-inline void localSearch(VariableNeighborhoodSearch::Candidate& best,
-                        const std::vector<std::pair<float, float>>& cities,
+/* Tries kNeighborhood random 2-opt moves at a time and rolls them back unless together they shorten the tour. */
+template <typename Tour, typename DistanceTable>
+inline void localSearch(Tour& tour,
+                        float& tourCost,
+                        const DistanceTable& distances,
                         const int kNoImproveLimit,
-                        const int kNeighborhood)
+                        const int kNeighborhood,
+                        Random& random,
+                        std::vector<TwoOptMove>& log)
 {
     int count = 0;
     while (count < kNoImproveLimit)
     {
-        VariableNeighborhoodSearch::Candidate candidate;
-        candidate.permutation = best.permutation;
+        const size_t mark = log.size();
+        float delta = 0.0f;
         for (int i = 0; i < kNeighborhood; ++i)
         {
-            stochasticTwoOpt(candidate.permutation);
+            delta += stochasticTwoOpt(tour, distances, random, log);
         }
-        candidate.cost = cost(cities, candidate.permutation);
-        if (candidate.cost < best.cost)
+        if (delta < 0.0f)
         {
-            best.permutation.swap(candidate.permutation);
-            best.cost = candidate.cost;
+            tourCost += delta;
             count = 0;
         }
         else
         {
+            rollback(tour, log, mark);
             ++count;
         }
     }
 }
 
-} /* anonymous namespace */
 
-
-VariableNeighborhoodSearch::Candidate VariableNeighborhoodSearch::search(const std::vector<std::pair<float, float>>& cities,
-                                                                         const std::vector<int>& neighborhoods,
-                                                                         const int kNoImproveLimit,
-                                                                         const int kLsNoImproveLimit)
+/*
+ * search() for one tour type and distance storage: Distances::dispatch() instantiates run() for the storage it picks.
+ * Shaking and local search move the one tour in place; a neighbourhood that does not improve it is rolled back.
+ */
+template <typename Tour>
+struct Search
+{
+    template <typename DistanceTable>
+    static VariableNeighborhoodSearch::Candidate run(const DistanceTable& distances,
+                                                     const std::vector<int>& neighborhoods,
+                                                     const int kNoImproveLimit,
+                                                     const int kLsNoImproveLimit,
+                                                     const uint64_t kSeed);
+};
+
+
+template <typename Tour>
+template <typename DistanceTable>
+VariableNeighborhoodSearch::Candidate Search<Tour>::run(const DistanceTable& distances,
+                                                        const std::vector<int>& neighborhoods,
+                                                        const int kNoImproveLimit,
+                                                        const int kLsNoImproveLimit,
+                                                        const uint64_t kSeed)
 {
-    srand(static_cast<unsigned>(time(nullptr)));
+    Random random(kSeed);
 
-    VariableNeighborhoodSearch::Candidate best;
-    best.permutation = randomPermutation(cities);
-    best.cost = cost(cities, best.permutation);
+    const std::vector<int> permutation = randomPermutation(distances, random);
+    float bestCost = cost(distances, permutation);
+    Tour tour;
+    tour.assign(permutation);
+    std::vector<TwoOptMove> log;
     int count = 0;
     while (count < kNoImproveLimit)
     {
         for (size_t i = 0; i < neighborhoods.size(); ++i)
         {
             int neigh = neighborhoods[i];
-            VariableNeighborhoodSearch::Candidate candidate;
-            candidate.permutation = best.permutation;
+            log.clear();
+            float candidateCost = bestCost;
             for (int iter = 0; iter < neigh; ++iter)
             {
-                stochasticTwoOpt(candidate.permutation);
+                candidateCost += stochasticTwoOpt(tour, distances, random, log);
             }
-            candidate.cost = cost(cities, candidate.permutation);
-            localSearch(candidate, cities, kLsNoImproveLimit, neigh);
-            if (candidate.cost < best.cost)
+            localSearch(tour, candidateCost, distances, kLsNoImproveLimit, neigh, random, log);
+            if (candidateCost < bestCost)
             {
-                best.permutation.swap(candidate.permutation);
-                best.cost = candidate.cost;
+                bestCost = candidateCost;
                 count = 0;
                 break;
             }
             else
             {
+                rollback(tour, log, 0);
                 ++count;
             }
         }
     }
+
+    VariableNeighborhoodSearch::Candidate best;
+    tour.permutation(best.permutation);
+    best.cost = cost(distances, best.permutation);
     return best;
 }
 
+} /* anonymous namespace */
+
+
+VariableNeighborhoodSearch::Candidate VariableNeighborhoodSearch::search(const std::vector<std::pair<float, float>>& cities,
+                                                                         const std::vector<int>& neighborhoods,
+                                                                         const int kNoImproveLimit,
+                                                                         const int kLsNoImproveLimit,
+                                                                         const uint64_t kSeed)
+{
+    return search(TspInstance(cities), neighborhoods, kNoImproveLimit, kLsNoImproveLimit, kSeed);
+}
+
+
+VariableNeighborhoodSearch::Candidate VariableNeighborhoodSearch::search(const TspInstance& instance,
+                                                                         const std::vector<int>& neighborhoods,
+                                                                         const int kNoImproveLimit,
+                                                                         const int kLsNoImproveLimit,
+                                                                         const uint64_t kSeed)
+{
+    if (instance.size() >= kTwoLevelListMinSize)
+    {
+        return Distances::dispatch<Search<TwoLevelListTour>>(instance, Distances::Policy::Auto, neighborhoods, kNoImproveLimit,
+                                                             kLsNoImproveLimit, kSeed);
+    }
+    return Distances::dispatch<Search<ArrayTour>>(instance, Distances::Policy::Auto, neighborhoods, kNoImproveLimit, kLsNoImproveLimit, kSeed);
+}
+
 } /* namespace CleverAlgorithms */
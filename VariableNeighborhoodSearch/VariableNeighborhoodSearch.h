@@ -8,8 +8,11 @@
 #define VARIABLENEIGHBORHOODSEARCH_H_02AE2378_2B29_11E5_849E_C038963D1C06
 
 
+#include <cstdint>
 #include <vector>
 
+#include "../Common/TspInstance.h"
+
 
 namespace CleverAlgorithms
 {
@@ -28,7 +31,14 @@ public:
     static Candidate search(const std::vector<std::pair<float, float>>& cities,
                             const std::vector<int>& neighborhoods,
                             const int kNoImproveLimit,
-                            const int kLsNoImproveLimit);
+                            const int kLsNoImproveLimit,
+                            const uint64_t kSeed);
+
+    static Candidate search(const TspInstance& instance,
+                            const std::vector<int>& neighborhoods,
+                            const int kNoImproveLimit,
+                            const int kLsNoImproveLimit,
+                            const uint64_t kSeed);
 };
 
 } /* namespace CleverAlgorithms */